@@ -0,0 +1,260 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <cstdio>
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CLIP_SPACE_USE_SSE 1
+#endif
+#include "main.h"
+#include "options.h"
+#include "culling.h"
+#include "clip_space.h"
+
+// counters
+static unsigned long polygons = 0;
+static unsigned long accepted = 0;
+static unsigned long rejected = 0;
+static unsigned long clipped = 0;
+static unsigned long clipped_away = 0;
+static unsigned long vertices_drawn = 0;
+
+bool
+clip_space_enabled()
+{
+  static const bool result = option_enabled("CLIP_SPACE");
+  return result;
+}
+
+unsigned int
+clip_space_outcode(const clip_vertex &v,
+                   GLfloat near_w,
+                   GLfloat far_w)
+{
+  unsigned int code = 0;
+#ifdef CLIP_SPACE_USE_SSE
+  // (x, y, -x, -y) > (w, w, w, w) gives the right, top, left and
+  // bottom bits, in that order
+  const __m128 sides = _mm_setr_ps(v.x, v.y, -v.x, -v.y);
+  code = (unsigned int) _mm_movemask_ps(_mm_cmpgt_ps(sides, _mm_set1_ps(v.w)));
+#else
+  if(v.x > v.w){
+    code |= clip_right;
+  }
+  if(v.y > v.w){
+    code |= clip_top;
+  }
+  if(-v.x > v.w){
+    code |= clip_left;
+  }
+  if(-v.y > v.w){
+    code |= clip_bottom;
+  }
+#endif
+  if(v.w < near_w){
+    code |= clip_near;
+  }
+  if(v.w > far_w){
+    code |= clip_far;
+  }
+  return code;
+}
+
+// how far inside "plane" a vertex is; negative if outside
+static GLfloat
+distance_inside(const clip_vertex &v,
+                unsigned int plane,
+                GLfloat near_w,
+                GLfloat far_w)
+{
+  switch(plane){
+  case clip_right:  return v.w - v.x;
+  case clip_top:    return v.w - v.y;
+  case clip_left:   return v.w + v.x;
+  case clip_bottom: return v.w + v.y;
+  case clip_near:   return v.w - near_w;
+  default:          return far_w - v.w;
+  }
+}
+
+// the point "t" of the way from "a" to "b"
+static clip_vertex
+between(const clip_vertex &a,
+        const clip_vertex &b,
+        GLfloat t)
+{
+  clip_vertex result;
+#ifdef CLIP_SPACE_USE_SSE
+  const __m128 from = _mm_loadu_ps(&a.x);
+  const __m128 to = _mm_loadu_ps(&b.x);
+  _mm_storeu_ps(&result.x,
+                _mm_add_ps(from, _mm_mul_ps(_mm_set1_ps(t), _mm_sub_ps(to, from))));
+#else
+  result.x = a.x + t * (b.x - a.x);
+  result.y = a.y + t * (b.y - a.y);
+  result.z = a.z + t * (b.z - a.z);
+  result.w = a.w + t * (b.w - a.w);
+#endif
+  return result;
+}
+
+// one pass of Sutherland and Hodgman: keep the part of the polygon
+// inside "plane"
+static int
+clip_to_plane(const clip_vertex *in,
+              int count,
+              unsigned int plane,
+              GLfloat near_w,
+              GLfloat far_w,
+              clip_vertex *out)
+{
+  int written = 0;
+  const clip_vertex *previous = &in[count - 1];
+  GLfloat previous_distance = distance_inside(*previous, plane, near_w, far_w);
+  for(int i = 0; i < count; i++){
+    const clip_vertex *current = &in[i];
+    const GLfloat current_distance = distance_inside(*current, plane, near_w, far_w);
+    // an edge which crosses the plane contributes where it crosses
+    if((previous_distance >= 0.0f) != (current_distance >= 0.0f)){
+      out[written++] = between(*previous,
+                               *current,
+                               previous_distance / (previous_distance - current_distance));
+    }
+    if(current_distance >= 0.0f){
+      out[written++] = *current;
+    }
+    previous = current;
+    previous_distance = current_distance;
+  }
+  return written;
+}
+
+int
+clip_space_clip_polygon(const clip_vertex *in,
+                        int count,
+                        GLfloat near_w,
+                        GLfloat far_w,
+                        clip_vertex *out)
+{
+  unsigned int any_outside = 0;
+  unsigned int all_outside = ~0u;
+  for(int i = 0; i < count; i++){
+    const unsigned int code = clip_space_outcode(in[i], near_w, far_w);
+    any_outside |= code;
+    all_outside &= code;
+  }
+  polygons++;
+  if(all_outside != 0){
+    rejected++;
+    return 0;
+  }
+  if(any_outside == 0){
+    accepted++;
+    for(int i = 0; i < count; i++){
+      out[i] = in[i];
+    }
+    return count;
+  }
+  clipped++;
+  // the near plane first, so that no vertex with w <= 0 reaches the
+  // others
+  static const unsigned int planes[6] = {
+    clip_near, clip_far, clip_left, clip_right, clip_bottom, clip_top
+  };
+  clip_vertex scratch[2][clip_space_max_vertices];
+  const clip_vertex *from = in;
+  int n = count;
+  int next = 0;
+  for(int p = 0; p < 6 && n > 0; p++){
+    if(!(any_outside & planes[p])){
+      continue;
+    }
+    n = clip_to_plane(from, n, planes[p], near_w, far_w, scratch[next]);
+    from = scratch[next];
+    next = 1 - next;
+  }
+  if(n < 3){
+    clipped_away++;
+    return 0;
+  }
+  for(int i = 0; i < n; i++){
+    out[i] = from[i];
+  }
+  return n;
+}
+
+void
+clip_space_divide(const clip_vertex *in,
+                  int count,
+                  GLfloat *ndc)
+{
+  for(int i = 0; i < count; i++){
+    // one division per vertex, then multiplications
+    const GLfloat inverse_w = 1.0f / in[i].w;
+    ndc[3*i + 0] = in[i].x * inverse_w;
+    ndc[3*i + 1] = in[i].y * inverse_w;
+    ndc[3*i + 2] = in[i].z;
+  }
+}
+
+void
+clip_space_draw_polygons(const clip_vertex *corners,
+                         size_t number_of_polygons,
+                         int corners_per_polygon,
+                         GLfloat near_w,
+                         GLfloat far_w)
+{
+  clip_vertex visible[clip_space_max_vertices];
+  GLfloat ndc[3 * clip_space_max_vertices];
+  bool begun = false;
+  for(size_t p = 0; p < number_of_polygons; p++){
+    const int n = clip_space_clip_polygon(corners + p * corners_per_polygon,
+                                          corners_per_polygon,
+                                          near_w,
+                                          far_w,
+                                          visible);
+    if(n == 0){
+      continue;
+    }
+    clip_space_divide(visible, n, ndc);
+    if(culling_enabled() && !culling_keep(ndc, n)){
+      continue;
+    }
+    // nothing is sent unless something is visible
+    if(!begun){
+      glBegin(GL_TRIANGLES);
+      begun = true;
+    }
+    // a fan about the first vertex
+    for(int i = 1; i + 1 < n; i++){
+      glVertex3f(ndc[0], ndc[1], ndc[2]);
+      glVertex3f(ndc[3*i + 0], ndc[3*i + 1], ndc[3*i + 2]);
+      glVertex3f(ndc[3*i + 3], ndc[3*i + 4], ndc[3*i + 5]);
+    }
+    vertices_drawn += 3 * (n - 2);
+  }
+  if(begun){
+    glEnd();
+  }
+}
+
+void
+clip_space_report()
+{
+  if(polygons == 0){
+    return;
+  }
+  fprintf(stderr,
+          "clip space: %lu polygons, %lu accepted, %lu rejected, "
+          "%lu clipped (%lu of those entirely), %lu vertices drawn\n",
+          polygons,
+          accepted,
+          rejected,
+          clipped,
+          clipped_away,
+          vertices_drawn);
+}
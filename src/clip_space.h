@@ -0,0 +1,100 @@
+#ifndef CLIP_SPACE_H
+#define CLIP_SPACE_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stddef.h>
+
+/* Clipping in homogeneous coordinates, for chapter 16's perspective.
+ *
+ * "Vertex3::perspective" divides x and y by the distance in front of
+ * the camera straight away.  A vertex behind the camera is mirrored in
+ * front of it, one beside the camera is divided by almost nothing, and
+ * a polygon entirely outside the view is still sent to be rasterized.
+ *
+ * Instead, each vertex is taken to clip space, where "w" is the
+ * distance which "perspective" divides by and the view is
+ * -w <= x <= w, -w <= y <= w, and near <= w <= far.  Each vertex gets
+ * an outcode, one bit per plane it is outside of.  A polygon whose
+ * vertices are all outside one plane is dropped, and one whose
+ * vertices are all inside every plane is drawn as is.  Only those
+ * between are clipped against each plane in turn, by Sutherland and
+ * Hodgman's method, and only then is each remaining vertex divided,
+ * by multiplying by 1/w.  Where SSE is available, a vertex's four
+ * coordinates are tested, and interpolated along an edge, at once.
+ *
+ * "z" is kept in NDC, as "perspective" computes it: linear in depth,
+ * so that chapter 16's depth test is unchanged.  Clip space is an
+ * affine function of camera space, so "z" may be interpolated along
+ * an edge like the other coordinates, but is not divided.
+ *
+ * Enabled by setting MVP_CLIP_SPACE=1 in the environment.  The number
+ * of polygons accepted, rejected and clipped is printed to stderr at
+ * exit.
+ */
+
+struct clip_vertex {
+  GLfloat x, y, z, w;
+};
+
+/* which planes a vertex is outside of */
+enum {
+  clip_right  = 1,
+  clip_top    = 2,
+  clip_left   = 4,
+  clip_bottom = 8,
+  clip_near   = 16,
+  clip_far    = 32
+};
+
+/* a convex polygon of n vertices has at most n + 6 once clipped, one
+ * more per plane
+ */
+enum { clip_space_max_vertices = 16 };
+
+bool
+clip_space_enabled();
+
+unsigned int
+clip_space_outcode(const clip_vertex &v,
+                   GLfloat near_w,
+                   GLfloat far_w);
+
+/* clip the convex polygon "in", of "count" vertices, no more than
+ * clip_space_max_vertices - 6, to the view, writing the result into
+ * "out", which must hold "count" + 6.
+ * Returns the number of vertices written, 0 if none of it is visible.
+ */
+int
+clip_space_clip_polygon(const clip_vertex *in,
+                        int count,
+                        GLfloat near_w,
+                        GLfloat far_w,
+                        clip_vertex *out);
+
+/* x, y and z in NDC of each of "count" vertices, into "ndc" */
+void
+clip_space_divide(const clip_vertex *in,
+                  int count,
+                  GLfloat *ndc);
+
+/* clip, divide and draw "number_of_polygons" convex polygons, of
+ * "corners_per_polygon" consecutive vertices each, with the current
+ * color, as triangles.  With MVP_CULLING, polygons which would draw
+ * nothing are dropped after the divide (see "culling.h").
+ */
+void
+clip_space_draw_polygons(const clip_vertex *corners,
+                         size_t number_of_polygons,
+                         int corners_per_polygon,
+                         GLfloat near_w,
+                         GLfloat far_w);
+
+void
+clip_space_report();
+
+#endif
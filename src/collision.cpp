@@ -0,0 +1,305 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "main.h"
+#include "options.h"
+#include "collision.h"
+
+typedef std::chrono::steady_clock collision_clock;
+
+// the sine and cosine of a box's rotation
+struct collision_orientation {
+  GLfloat cos, sin;
+};
+
+// axis-aligned bounds of a box
+struct collision_bounds {
+  GLfloat min_x, min_y, max_x, max_y;
+};
+
+// a box which drifts about, to measure the cost of many bodies
+struct test_body {
+  collision_box box;
+  GLfloat velocity_x, velocity_y, spin;
+};
+
+// a body in a cell, with what the broad phase needs of it, so that
+// the bodies of a cell are adjacent in memory
+struct cell_entry {
+  collision_bounds bounds;
+  uint32_t body;
+};
+
+// the cells a body covers
+struct cell_range {
+  int min_column, min_row, max_column, max_row;
+};
+
+// scratch space, kept between calls so as not to allocate every frame
+static std::vector<collision_orientation> orientations;
+static std::vector<collision_bounds> bounds;
+static std::vector<cell_range> ranges;
+static std::vector<uint32_t> cell_start;
+static std::vector<cell_entry> cell_entries;
+
+static std::vector<test_body> test_bodies;
+static GLfloat test_region = 0.0f; // half the side of the square they stay in
+
+// counters
+static unsigned long calls = 0;
+static unsigned long bodies_tested = 0;
+static unsigned long pairs_found = 0;
+static collision_clock::duration time_spent = collision_clock::duration::zero();
+
+bool
+collision_enabled()
+{
+  static const bool result = option_enabled("COLLISIONS");
+  return result;
+}
+
+static collision_orientation
+orientation_of(const collision_box &box)
+{
+  const collision_orientation result = {std::cos(box.rotation), std::sin(box.rotation)};
+  return result;
+}
+
+static bool
+overlap(const collision_box &a,
+        const collision_orientation &o_a,
+        const collision_box &b,
+        const collision_orientation &o_b)
+{
+  // the edge directions of both boxes
+  const GLfloat axes[4][2] = {
+    {o_a.cos, o_a.sin}, {-o_a.sin, o_a.cos},
+    {o_b.cos, o_b.sin}, {-o_b.sin, o_b.cos}
+  };
+  const GLfloat d_x = b.x - a.x;
+  const GLfloat d_y = b.y - a.y;
+  for(int e = 0; e < 4; e++){
+    const GLfloat x = axes[e][0], y = axes[e][1];
+    // half the length of each box's projection onto the axis
+    const GLfloat radius_a = a.half_width * std::fabs(o_a.cos * x + o_a.sin * y)
+      + a.half_height * std::fabs(-o_a.sin * x + o_a.cos * y);
+    const GLfloat radius_b = b.half_width * std::fabs(o_b.cos * x + o_b.sin * y)
+      + b.half_height * std::fabs(-o_b.sin * x + o_b.cos * y);
+    if(std::fabs(d_x * x + d_y * y) > radius_a + radius_b){
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+collision_boxes_overlap(const collision_box &a,
+                        const collision_box &b)
+{
+  return overlap(a, orientation_of(a), b, orientation_of(b));
+}
+
+static collision_bounds
+bounds_of(const collision_box &box,
+          const collision_orientation &o)
+{
+  const GLfloat c = std::fabs(o.cos);
+  const GLfloat s = std::fabs(o.sin);
+  const GLfloat extent_x = c * box.half_width + s * box.half_height;
+  const GLfloat extent_y = s * box.half_width + c * box.half_height;
+  const collision_bounds result = {box.x - extent_x,
+                                   box.y - extent_y,
+                                   box.x + extent_x,
+                                   box.y + extent_y};
+  return result;
+}
+
+static void
+find_pairs(const std::vector<collision_box> &boxes,
+           std::vector<collision_pair> *pairs)
+{
+  const size_t n = boxes.size();
+  if(n < 2){
+    return;
+  }
+  orientations.resize(n);
+  bounds.resize(n);
+  ranges.resize(n);
+  orientations[0] = orientation_of(boxes[0]);
+  collision_bounds world = bounds_of(boxes[0], orientations[0]);
+  double total_extent = 0.0;
+  for(size_t i = 0; i < n; i++){
+    orientations[i] = orientation_of(boxes[i]);
+    const collision_bounds b = bounds_of(boxes[i], orientations[i]);
+    bounds[i] = b;
+    world.min_x = std::min(world.min_x, b.min_x);
+    world.min_y = std::min(world.min_y, b.min_y);
+    world.max_x = std::max(world.max_x, b.max_x);
+    world.max_y = std::max(world.max_y, b.max_y);
+    total_extent += (b.max_x - b.min_x) + (b.max_y - b.min_y);
+  }
+
+  // cells the size of the average body, but no more than a few per
+  // body, so that sparse scenes do not allocate vast empty grids
+  double cell = std::max(total_extent / (2.0 * n), 1e-3);
+  int columns, rows;
+  for(;;){
+    columns = (int) ((world.max_x - world.min_x) / cell) + 1;
+    rows = (int) ((world.max_y - world.min_y) / cell) + 1;
+    if((double) columns * rows <= 4.0 * n + 16.0){
+      break;
+    }
+    cell *= 2.0;
+  }
+  const double inverse_cell = 1.0 / cell;
+  auto column_of = [&](GLfloat x){
+    return std::min(columns - 1, (int) ((x - world.min_x) * inverse_cell));
+  };
+  auto row_of = [&](GLfloat y){
+    return std::min(rows - 1, (int) ((y - world.min_y) * inverse_cell));
+  };
+
+  // count the bodies in each cell, then place them in order of cell.
+  // Placing counts each cell's end back down to its start.
+  const size_t cells = (size_t) columns * rows;
+  cell_start.assign(cells + 1, 0);
+  for(size_t i = 0; i < n; i++){
+    const collision_bounds &b = bounds[i];
+    const cell_range r = {column_of(b.min_x), row_of(b.min_y),
+                          column_of(b.max_x), row_of(b.max_y)};
+    ranges[i] = r;
+    for(int row = r.min_row; row <= r.max_row; row++){
+      for(int column = r.min_column; column <= r.max_column; column++){
+        cell_start[(size_t) row * columns + column]++;
+      }
+    }
+  }
+  for(size_t c = 1; c <= cells; c++){
+    cell_start[c] += cell_start[c - 1];
+  }
+  cell_entries.resize(cell_start[cells]);
+  for(size_t i = 0; i < n; i++){
+    const cell_range &r = ranges[i];
+    const cell_entry entry = {bounds[i], (uint32_t) i};
+    for(int row = r.min_row; row <= r.max_row; row++){
+      for(int column = r.min_column; column <= r.max_column; column++){
+        cell_entries[--cell_start[(size_t) row * columns + column]] = entry;
+      }
+    }
+  }
+
+  for(int row = 0; row < rows; row++){
+    for(int column = 0; column < columns; column++){
+      const size_t c = (size_t) row * columns + column;
+      const cell_entry *first = &cell_entries[0] + cell_start[c];
+      const cell_entry *last = &cell_entries[0] + cell_start[c + 1];
+      for(const cell_entry *i = first; i < last; i++){
+        const collision_bounds &a = i->bounds;
+        for(const cell_entry *j = i + 1; j < last; j++){
+          const collision_bounds &b = j->bounds;
+          if(a.max_x < b.min_x || b.max_x < a.min_x
+             || a.max_y < b.min_y || b.max_y < a.min_y){
+            continue;
+          }
+          // compared only in the cell holding the overlap's corner
+          if(column_of(std::max(a.min_x, b.min_x)) != column
+             || row_of(std::max(a.min_y, b.min_y)) != row){
+            continue;
+          }
+          if(overlap(boxes[i->body], orientations[i->body],
+                     boxes[j->body], orientations[j->body])){
+            const collision_pair pair = {std::min(i->body, j->body),
+                                         std::max(i->body, j->body)};
+            pairs->push_back(pair);
+          }
+        }
+      }
+    }
+  }
+}
+
+void
+collision_find_pairs(const std::vector<collision_box> &boxes,
+                     std::vector<collision_pair> *pairs)
+{
+  const collision_clock::time_point start = collision_clock::now();
+  pairs->clear();
+  find_pairs(boxes, pairs);
+  time_spent += collision_clock::now() - start;
+  calls++;
+  bodies_tested += boxes.size();
+  pairs_found += pairs->size();
+}
+
+// the same bodies in every run
+static GLfloat
+random_between(uint32_t *seed,
+               GLfloat low,
+               GLfloat high)
+{
+  *seed = *seed * 1664525u + 1013904223u;
+  return low + (high - low) * (GLfloat) (*seed >> 8) / (GLfloat) (1u << 24);
+}
+
+void
+collision_add_test_bodies(std::vector<collision_box> *boxes)
+{
+  const int wanted = option_int("COLLISION_BODIES", 0);
+  if(wanted <= 0){
+    return;
+  }
+  if(test_bodies.empty()){
+    // about as crowded as the paddles and the square, however many
+    test_region = 10.0f * std::sqrt((GLfloat) wanted);
+    uint32_t seed = 1;
+    test_bodies.resize(wanted);
+    for(size_t i = 0; i < test_bodies.size(); i++){
+      test_body &body = test_bodies[i];
+      body.box.x = random_between(&seed, -test_region, test_region);
+      body.box.y = random_between(&seed, -test_region, test_region);
+      body.box.half_width = random_between(&seed, 1.0f, 4.0f);
+      body.box.half_height = random_between(&seed, 1.0f, 4.0f);
+      body.box.rotation = random_between(&seed, 0.0f, 6.283f);
+      body.velocity_x = random_between(&seed, -1.0f, 1.0f);
+      body.velocity_y = random_between(&seed, -1.0f, 1.0f);
+      body.spin = random_between(&seed, -0.05f, 0.05f);
+    }
+  }
+  for(size_t i = 0; i < test_bodies.size(); i++){
+    test_body &body = test_bodies[i];
+    body.box.x += body.velocity_x;
+    body.box.y += body.velocity_y;
+    body.box.rotation += body.spin;
+    // bounce off the edges of the region
+    if(std::fabs(body.box.x) > test_region){
+      body.velocity_x = -body.velocity_x;
+    }
+    if(std::fabs(body.box.y) > test_region){
+      body.velocity_y = -body.velocity_y;
+    }
+    boxes->push_back(body.box);
+  }
+}
+
+void
+collision_report()
+{
+  if(calls == 0){
+    return;
+  }
+  fprintf(stderr,
+          "collision: %.0f bodies and %.1f overlapping pairs per frame, %.3f ms per frame\n",
+          (double) bodies_tested / calls,
+          (double) pairs_found / calls,
+          std::chrono::duration<double>(time_spent).count() * 1000.0 / calls);
+}
@@ -0,0 +1,74 @@
+#ifndef COLLISION_H
+#define COLLISION_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+#include <vector>
+
+/* Collision detection between rectangles in the world's x-y plane.
+ *
+ * Testing every pair of n bodies costs n^2.  Instead, a uniform grid,
+ * whose cells are about the size of the average body, is laid over
+ * the bodies' axis-aligned bounds, and only bodies which share a cell
+ * are compared (the "broad phase").  A pair which shares several
+ * cells is compared only in the cell holding the corner of their
+ * bounds' overlap, so each pair is found once.  The grid is rebuilt
+ * every call by a counting sort, so the cost is linear in the number
+ * of bodies, as long as they are of similar size.  (Sorting the bounds
+ * along one axis, "sweep and prune", compares every pair whose bounds
+ * overlap on that axis, which for bodies spread over a plane grows as
+ * n^1.5.)
+ *
+ * A pair whose bounds overlap is then tested exactly (the "narrow
+ * phase"), by the separating axis theorem: two rectangles are apart if
+ * and only if their projections onto one of the four edge directions
+ * are apart.
+ *
+ * Enabled by setting MVP_COLLISIONS=1 in the environment.
+ * MVP_COLLISION_BODIES, if set, adds that many boxes which drift about
+ * the scene, to measure the cost; they are not drawn.  The mean time
+ * per frame is printed to stderr at exit.
+ */
+
+/* a rectangle of the given half-extents, rotated by "rotation" radians
+ * about its center
+ */
+struct collision_box {
+  GLfloat x, y;
+  GLfloat half_width, half_height;
+  GLfloat rotation;
+};
+
+/* indices of two boxes which overlap, with first < second */
+struct collision_pair {
+  uint32_t first, second;
+};
+
+bool
+collision_enabled();
+
+/* the narrow phase alone */
+bool
+collision_boxes_overlap(const collision_box &a,
+                        const collision_box &b);
+
+/* every pair of "boxes" which overlap, in no particular order */
+void
+collision_find_pairs(const std::vector<collision_box> &boxes,
+                     std::vector<collision_pair> *pairs);
+
+/* append MVP_COLLISION_BODIES boxes, each moved one step further than
+ * in the previous call
+ */
+void
+collision_add_test_bodies(std::vector<collision_box> *boxes);
+
+void
+collision_report();
+
+#endif
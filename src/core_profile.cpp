@@ -0,0 +1,243 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <cstdio>
+#include <vector>
+#include "main.h"
+#include "matrix.h"
+#include "options.h"
+#include "core_profile.h"
+
+static const char *vertex_shader_source =
+  "#version 330 core\n"
+  "layout(location = 0) in vec3 position;\n"
+  "uniform mat4 model;\n"
+  "uniform mat4 camera;\n"
+  "uniform mat4 projection;\n"
+  "void main()\n"
+  "{\n"
+  "  gl_Position = projection * camera * model * vec4(position, 1.0);\n"
+  "}\n";
+
+static const char *fragment_shader_source =
+  "#version 330 core\n"
+  "uniform vec3 color;\n"
+  "out vec4 fragment_color;\n"
+  "void main()\n"
+  "{\n"
+  "  fragment_color = vec4(color, 1.0);\n"
+  "}\n";
+
+static bool active = false;
+static GLuint program = 0;
+static GLuint square_vao = 0;
+static GLuint square_vbo = 0;
+static GLint model_location = -1;
+static GLint camera_location = -1;
+static GLint projection_location = -1;
+static GLint color_location = -1;
+
+bool
+core_profile_requested()
+{
+  return option_enabled("CORE_PROFILE");
+}
+
+bool
+core_profile_active()
+{
+  return active;
+}
+
+static GLuint
+compile_shader(GLenum type,
+               const char *source)
+{
+  GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, NULL);
+  glCompileShader(shader);
+  GLint compiled = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if(!compiled){
+    GLint length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+    std::vector<char> log(length + 1, '\0');
+    glGetShaderInfoLog(shader, length, NULL, &log[0]);
+    fprintf(stderr, "Error: shader compilation failed: %s\n", &log[0]);
+    glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
+
+bool
+core_profile_init()
+{
+  GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER,
+                                        vertex_shader_source);
+  GLuint fragment_shader = compile_shader(GL_FRAGMENT_SHADER,
+                                          fragment_shader_source);
+  if(!vertex_shader || !fragment_shader){
+    return false;
+  }
+  program = glCreateProgram();
+  glAttachShader(program, vertex_shader);
+  glAttachShader(program, fragment_shader);
+  glLinkProgram(program);
+  // the program keeps the compiled code alive
+  glDeleteShader(vertex_shader);
+  glDeleteShader(fragment_shader);
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if(!linked){
+    GLint length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+    std::vector<char> log(length + 1, '\0');
+    glGetProgramInfoLog(program, length, NULL, &log[0]);
+    fprintf(stderr, "Error: shader link failed: %s\n", &log[0]);
+    glDeleteProgram(program);
+    program = 0;
+    return false;
+  }
+  model_location = glGetUniformLocation(program, "model");
+  camera_location = glGetUniformLocation(program, "camera");
+  projection_location = glGetUniformLocation(program, "projection");
+  color_location = glGetUniformLocation(program, "color");
+
+  // the same square as "draw_square_opengl2point1", as a triangle fan
+  const GLfloat square[] = {
+    /*x*/ -1.0, /*y*/ -1.0, /*z*/ 0.0,
+    /*x*/  1.0, /*y*/ -1.0, /*z*/ 0.0,
+    /*x*/  1.0, /*y*/  1.0, /*z*/ 0.0,
+    /*x*/ -1.0, /*y*/  1.0, /*z*/ 0.0
+  };
+  glGenVertexArrays(1, &square_vao);
+  glBindVertexArray(square_vao);
+  glGenBuffers(1, &square_vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, square_vbo);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(square), square, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(/*index*/ 0,
+                        /*size*/ 3,
+                        GL_FLOAT,
+                        /*normalized*/ GL_FALSE,
+                        /*stride*/ 0,
+                        /*offset*/ 0);
+  glBindVertexArray(0);
+  active = true;
+  return true;
+}
+
+static void
+draw_square(const Matrix4 &model,
+            GLfloat red,
+            GLfloat green,
+            GLfloat blue)
+{
+  glUniformMatrix4fv(model_location, 1, GL_FALSE, model.m);
+  glUniform3f(color_location, red, green, blue);
+  glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+}
+
+Matrix4
+core_profile_projection(const core_profile_scene &scene)
+{
+  const int w = scene.framebuffer_width;
+  const int h = scene.framebuffer_height;
+  // chapter 16's hand-written "perspective" and chapter 17's
+  // "gluPerspective" agree for a square window; use the latter.
+  return Matrix4::perspective(/*field_of_view*/ 45.0f,
+                              /*aspect*/ (h == 0) ? 1.0f : (GLfloat)w / (GLfloat)h,
+                              /*nearZ*/ 0.1f,
+                              /*farZ*/ 1000.0f);
+}
+
+Matrix4
+core_profile_camera(const core_profile_scene &scene)
+{
+  return Matrix4::identity()
+    .rotateX(/*radians*/ -scene.moving_camera_rot_x)
+    .rotateY(/*radians*/ -scene.moving_camera_rot_y)
+    .translate(/*x*/ -scene.moving_camera_x,
+               /*y*/ -scene.moving_camera_y,
+               /*z*/ -scene.moving_camera_z);
+}
+
+void
+core_profile_models(const core_profile_scene &scene,
+                    Matrix4 models[3])
+{
+  // paddle 1, relative to the world-space origin
+  const Matrix4 paddle_1 = Matrix4::identity()
+    .translate(/*x*/ -90.0f,
+               /*y*/ scene.paddle_1_offset_Y,
+               /*z*/ 0.0f)
+    .rotateZ(/*radians*/ scene.paddle_1_rotation);
+  models[0] = paddle_1.scale(/*x*/ 10.0f,
+                             /*y*/ 30.0f,
+                             /*z*/ 1.0f);
+  // the square, relative to paddle 1
+  models[1] = paddle_1
+    .rotateZ(/*radians*/ scene.rotation_around_paddle_1)
+    .translate(/*x*/ 20.0f,
+               /*y*/ 0.0f,
+               /*z*/ -10.0f)
+    .rotateZ(/*radians*/ scene.square_rotation)
+    .scale(/*x*/ 5.0f,
+           /*y*/ 5.0f,
+           /*z*/ 1.0f);
+  // paddle 2, relative to the world-space origin
+  models[2] = Matrix4::identity()
+    .translate(/*x*/ 90.0f,
+               /*y*/ scene.paddle_2_offset_Y,
+               /*z*/ 0.0f)
+    .rotateZ(/*radians*/ scene.paddle_2_rotation)
+    .scale(/*x*/ 10.0f,
+           /*y*/ 30.0f,
+           /*z*/ 1.0f);
+}
+
+void
+core_profile_render(const core_profile_scene &scene)
+{
+  const Matrix4 projection = core_profile_projection(scene);
+  const Matrix4 camera = core_profile_camera(scene);
+  Matrix4 models[3];
+  core_profile_models(scene, models);
+
+  glUseProgram(program);
+  glUniformMatrix4fv(projection_location, 1, GL_FALSE, projection.m);
+  glUniformMatrix4fv(camera_location, 1, GL_FALSE, camera.m);
+  glBindVertexArray(square_vao);
+  draw_square(models[0],
+              /*red*/   1.0,
+              /*green*/ 1.0,
+              /*blue*/  1.0);
+  draw_square(models[1],
+              /*red*/   0.0,
+              /*green*/ 0.0,
+              /*blue*/  1.0);
+  draw_square(models[2],
+              /*red*/   1.0,
+              /*green*/ 1.0,
+              /*blue*/  0.0);
+
+  glBindVertexArray(0);
+  glUseProgram(0);
+}
+
+void
+core_profile_shutdown()
+{
+  if(!active){
+    return;
+  }
+  glDeleteBuffers(1, &square_vbo);
+  glDeleteVertexArrays(1, &square_vao);
+  glDeleteProgram(program);
+  active = false;
+}
@@ -0,0 +1,76 @@
+#ifndef CORE_PROFILE_H
+#define CORE_PROFILE_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include "matrix.h"
+
+/* Optional OpenGL 3.3 core-profile renderer for chapters 16 and 17.
+ *
+ * Instead of transforming vertices on the CPU (chapter 16) or through
+ * the fixed-function matrix stack (chapter 17), the model, camera and
+ * projection matrices are passed to a vertex shader as uniforms, and
+ * the graphics driver transforms every vertex.
+ *
+ * Enabled by setting MVP_CORE_PROFILE=1 in the environment.
+ */
+
+/* everything the chapter 16/17 scene depends upon */
+struct core_profile_scene {
+  GLfloat paddle_1_offset_Y;
+  GLfloat paddle_2_offset_Y;
+  GLfloat paddle_1_rotation;
+  GLfloat paddle_2_rotation;
+  GLfloat square_rotation;
+  GLfloat rotation_around_paddle_1;
+  GLfloat moving_camera_x;
+  GLfloat moving_camera_y;
+  GLfloat moving_camera_z;
+  GLfloat moving_camera_rot_x;
+  GLfloat moving_camera_rot_y;
+  int framebuffer_width;
+  int framebuffer_height;
+};
+
+/* true if the user asked for the core-profile renderer */
+bool
+core_profile_requested();
+
+/* true once core_profile_init has succeeded */
+bool
+core_profile_active();
+
+/* compile the shaders and upload the unit square.  Requires a current
+ * 3.3 core context, with GLEW initialized.  Returns false, after
+ * printing the reason to stderr, on failure.
+ */
+bool
+core_profile_init();
+
+/* the projection and camera which chapter 17 sets with
+ * "gluPerspective", "glRotatef" and "glTranslatef"
+ */
+Matrix4
+core_profile_projection(const core_profile_scene &scene);
+
+Matrix4
+core_profile_camera(const core_profile_scene &scene);
+
+/* the model matrices of paddle 1, the square, and paddle 2, each of
+ * which places the square from -1 to 1 in x and y
+ */
+void
+core_profile_models(const core_profile_scene &scene,
+                    Matrix4 models[3]);
+
+void
+core_profile_render(const core_profile_scene &scene);
+
+void
+core_profile_shutdown();
+
+#endif
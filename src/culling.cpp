@@ -0,0 +1,168 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "main.h"
+#include "options.h"
+#include "culling.h"
+
+// the most vertices in a polygon which is tested
+static const int max_vertices = 16;
+// bounds holding more pixel centers than this are assumed to cover one
+static const int max_centers_tested = 16;
+
+static GLfloat viewport_width = 0.0f;
+static GLfloat viewport_height = 0.0f;
+
+// counters for the current frame, and in total
+struct culling_counts {
+  unsigned long tested, degenerate, back_facing, small;
+};
+static culling_counts this_frame = {0, 0, 0, 0};
+static culling_counts total = {0, 0, 0, 0};
+static unsigned long most_culled_in_a_frame = 0;
+static unsigned long frames = 0;
+
+bool
+culling_enabled()
+{
+  static const bool result = option_enabled("CULLING");
+  return result;
+}
+
+void
+culling_begin_draw()
+{
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  viewport_width = (GLfloat) viewport[2];
+  viewport_height = (GLfloat) viewport[3];
+}
+
+// whether any pixel center lies inside the polygon at "pixels", of
+// "count" vertices winding counterclockwise
+static bool
+covers_a_pixel_center(const GLfloat *pixels,
+                      int count)
+{
+  GLfloat min_x = pixels[0], max_x = pixels[0];
+  GLfloat min_y = pixels[1], max_y = pixels[1];
+  for(int i = 1; i < count; i++){
+    min_x = std::min(min_x, pixels[2*i]);
+    max_x = std::max(max_x, pixels[2*i]);
+    min_y = std::min(min_y, pixels[2*i + 1]);
+    max_y = std::max(max_y, pixels[2*i + 1]);
+  }
+  // the pixel centers, at i + 0.5, within the bounds
+  const GLfloat first_column = std::ceil(min_x - 0.5f);
+  const GLfloat last_column = std::floor(max_x - 0.5f);
+  const GLfloat first_row = std::ceil(min_y - 0.5f);
+  const GLfloat last_row = std::floor(max_y - 0.5f);
+  if(first_column > last_column || first_row > last_row){
+    return false;
+  }
+  if((last_column - first_column + 1.0f) * (last_row - first_row + 1.0f)
+     > (GLfloat) max_centers_tested){
+    return true;
+  }
+  for(GLfloat row = first_row; row <= last_row; row++){
+    for(GLfloat column = first_column; column <= last_column; column++){
+      const GLfloat x = column + 0.5f, y = row + 0.5f;
+      bool inside = true;
+      for(int i = 0; i < count && inside; i++){
+        const GLfloat *a = &pixels[2*i];
+        const GLfloat *b = &pixels[2*((i + 1) % count)];
+        // to the left of, or on, each edge
+        inside = (b[0] - a[0]) * (y - a[1]) - (b[1] - a[1]) * (x - a[0]) >= 0.0f;
+      }
+      if(inside){
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool
+culling_keep(const GLfloat *ndc,
+             int count)
+{
+  static const bool cull_back_faces = option_int("CULL_BACK_FACES", 1) != 0;
+  this_frame.tested++;
+  if(count < 3 || count > max_vertices){
+    return count >= 3;
+  }
+  GLfloat pixels[2 * max_vertices];
+  for(int i = 0; i < count; i++){
+    pixels[2*i + 0] = (ndc[3*i + 0] + 1.0f) * 0.5f * viewport_width;
+    pixels[2*i + 1] = (ndc[3*i + 1] + 1.0f) * 0.5f * viewport_height;
+  }
+  // twice the signed area, in pixels; positive if counterclockwise
+  GLfloat area = 0.0f;
+  for(int i = 0; i < count; i++){
+    const GLfloat *a = &pixels[2*i];
+    const GLfloat *b = &pixels[2*((i + 1) % count)];
+    area += a[0] * b[1] - b[0] * a[1];
+  }
+  if(!(std::fabs(area) > 1e-6f)){
+    this_frame.degenerate++;
+    return false;
+  }
+  if(area < 0.0f){
+    if(cull_back_faces){
+      this_frame.back_facing++;
+      return false;
+    }
+    // test the pixel centers against the edges in the other order
+    for(int i = 0; i < count / 2; i++){
+      std::swap(pixels[2*i], pixels[2*(count - 1 - i)]);
+      std::swap(pixels[2*i + 1], pixels[2*(count - 1 - i) + 1]);
+    }
+  }
+  if(!covers_a_pixel_center(pixels, count)){
+    this_frame.small++;
+    return false;
+  }
+  return true;
+}
+
+void
+culling_end_frame()
+{
+  if(!culling_enabled()){
+    return;
+  }
+  const unsigned long culled =
+    this_frame.degenerate + this_frame.back_facing + this_frame.small;
+  most_culled_in_a_frame = std::max(most_culled_in_a_frame, culled);
+  total.tested += this_frame.tested;
+  total.degenerate += this_frame.degenerate;
+  total.back_facing += this_frame.back_facing;
+  total.small += this_frame.small;
+  const culling_counts zero = {0, 0, 0, 0};
+  this_frame = zero;
+  frames++;
+}
+
+void
+culling_report()
+{
+  if(frames == 0 || total.tested == 0){
+    return;
+  }
+  fprintf(stderr,
+          "culling: per frame, %.1f polygons tested, %.1f degenerate, "
+          "%.1f back-facing, %.1f covering no pixel center; "
+          "at most %lu culled in a frame\n",
+          (double) total.tested / frames,
+          (double) total.degenerate / frames,
+          (double) total.back_facing / frames,
+          (double) total.small / frames,
+          most_culled_in_a_frame);
+}
@@ -0,0 +1,55 @@
+#ifndef CULLING_H
+#define CULLING_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Culling of primitives which would draw nothing, in chapter 16.
+ *
+ * Once the CPU has taken a polygon's vertices to NDC, three kinds of
+ * polygon may be dropped before they are sent to be rasterized:
+ *
+ *   degenerate ones, of no area;
+ *   back-facing ones, whose vertices wind clockwise on the screen, as
+ *     OpenGL's front faces are counterclockwise;
+ *   small ones, which cover no pixel's center at the current
+ *     viewport's size, and so produce no fragments.
+ *
+ * A distant, detailed mesh is mostly the last kind.  A polygon whose
+ * bounds on the screen hold no pixel centers is dropped at once; if
+ * they hold only a few, each is tested against the polygon's edges.
+ *
+ * Enabled by setting MVP_CULLING=1 in the environment.  Setting
+ * MVP_CULL_BACK_FACES=0 keeps back-facing polygons, for instance to
+ * see the square from behind.  The number of polygons culled per
+ * frame, of each kind, is printed to stderr at exit.
+ */
+
+bool
+culling_enabled();
+
+/* read the viewport's size, for the following calls of
+ * "culling_keep"; call before each object, as a split screen (see
+ * "split_screen.h") changes it between them
+ */
+void
+culling_begin_draw();
+
+/* whether the convex polygon of "count" vertices, each x, y and z in
+ * NDC, may draw anything
+ */
+bool
+culling_keep(const GLfloat *ndc,
+             int count);
+
+void
+culling_end_frame();
+
+void
+culling_report();
+
+#endif
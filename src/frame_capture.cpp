@@ -0,0 +1,477 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "main.h"
+#include "options.h"
+#include "timeline.h"
+#include "frame_capture.h"
+
+// a pixel buffer object in the ring
+struct capture_slot {
+  GLuint buffer;
+  GLsizeiptr capacity;
+  GLsync fence;
+  bool pending;
+  int width, height;
+};
+
+// a frame's pixels, bottom row first, for a worker to encode
+struct capture_job {
+  unsigned long sequence;
+  int width, height;
+  std::vector<unsigned char> rgba;
+};
+
+static bool active = false;
+static bool video = false;
+static std::string output;
+static std::vector<capture_slot> slots;
+static size_t next_slot = 0;
+
+static std::vector<std::thread> workers;
+static std::mutex queue_mutex;
+static std::condition_variable queue_changed;
+static std::deque<capture_job> queue;
+static size_t queue_limit = 16;
+static bool finishing = false;
+
+// the video's frames are written in sequence, whichever worker
+// encoded them
+static FILE *video_file = NULL;
+static std::mutex video_mutex;
+static std::condition_variable video_turn;
+static unsigned long next_to_write = 0;
+static int video_width = 0, video_height = 0;
+static int video_fps = 60;
+
+// counters
+static unsigned long frames_read = 0;
+static unsigned long sequence = 0;
+static unsigned long dropped = 0;
+static unsigned long gpu_waits = 0;
+static std::atomic<unsigned long> written(0);
+static std::atomic<unsigned long> failed(0);
+
+bool
+frame_capture_requested()
+{
+  return option_string("CAPTURE", NULL) != NULL;
+}
+
+static bool
+ends_with(const std::string &s,
+          const char *suffix)
+{
+  const size_t n = strlen(suffix);
+  return s.size() >= n && 0 == s.compare(s.size() - n, n, suffix);
+}
+
+// true if "pattern", as a format for snprintf, takes exactly one
+// int: one "%d", with flags or a width, and otherwise only "%%"
+static bool
+one_frame_number(const std::string &pattern)
+{
+  int numbers = 0;
+  for(size_t i = 0; i < pattern.size(); i++){
+    if(pattern[i] != '%'){
+      continue;
+    }
+    i++;
+    if(i < pattern.size() && pattern[i] == '%'){
+      continue;
+    }
+    while(i < pattern.size() && strchr("-+ #0", pattern[i])){
+      i++;
+    }
+    while(i < pattern.size() && pattern[i] >= '0' && pattern[i] <= '9'){
+      i++;
+    }
+    if(i == pattern.size() || pattern[i] != 'd'){
+      return false;
+    }
+    numbers++;
+  }
+  return numbers == 1;
+}
+
+static void
+put_big_endian(std::vector<unsigned char> &out,
+               uint32_t value)
+{
+  out.push_back((unsigned char) (value >> 24));
+  out.push_back((unsigned char) (value >> 16));
+  out.push_back((unsigned char) (value >> 8));
+  out.push_back((unsigned char) value);
+}
+
+static uint32_t
+crc32(const unsigned char *data,
+      size_t size)
+{
+  static uint32_t table[256];
+  static std::once_flag table_made;
+  std::call_once(table_made, []{
+      for(uint32_t n = 0; n < 256; n++){
+        uint32_t c = n;
+        for(int k = 0; k < 8; k++){
+          c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[n] = c;
+      }
+    });
+  uint32_t c = 0xFFFFFFFFu;
+  for(size_t i = 0; i < size; i++){
+    c = table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+  }
+  return c ^ 0xFFFFFFFFu;
+}
+
+static void
+put_chunk(std::vector<unsigned char> &png,
+          const char *type,
+          const std::vector<unsigned char> &data)
+{
+  put_big_endian(png, (uint32_t) data.size());
+  const size_t start = png.size();
+  png.insert(png.end(), type, type + 4);
+  png.insert(png.end(), data.begin(), data.end());
+  put_big_endian(png, crc32(&png[start], png.size() - start));
+}
+
+static void
+write_png(const capture_job &job)
+{
+  // each row, top row first, is a filter byte of 0 ("none") and then
+  // red, green, and blue
+  const size_t row_bytes = 1 + 3 * (size_t) job.width;
+  std::vector<unsigned char> raw(row_bytes * job.height);
+  for(int y = 0; y < job.height; y++){
+    const unsigned char *from = &job.rgba[4 * (size_t) job.width * (job.height - 1 - y)];
+    unsigned char *to = &raw[row_bytes * y];
+    *to++ = 0;
+    for(int x = 0; x < job.width; x++){
+      *to++ = from[0];
+      *to++ = from[1];
+      *to++ = from[2];
+      from += 4;
+    }
+  }
+
+  // a zlib stream of uncompressed deflate blocks
+  std::vector<unsigned char> zlib;
+  zlib.push_back(0x78);
+  zlib.push_back(0x01);
+  uint32_t adler_a = 1, adler_b = 0;
+  for(size_t i = 0; i < raw.size(); i++){
+    adler_a = (adler_a + raw[i]) % 65521;
+    adler_b = (adler_b + adler_a) % 65521;
+  }
+  size_t offset = 0;
+  do{
+    const size_t length = std::min(raw.size() - offset, (size_t) 65535);
+    const bool final_block = offset + length == raw.size();
+    zlib.push_back(final_block ? 1 : 0);
+    zlib.push_back((unsigned char) length);
+    zlib.push_back((unsigned char) (length >> 8));
+    zlib.push_back((unsigned char) ~length);
+    zlib.push_back((unsigned char) (~length >> 8));
+    zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+    offset += length;
+  } while(offset < raw.size());
+  put_big_endian(zlib, (adler_b << 16) | adler_a);
+
+  std::vector<unsigned char> header;
+  put_big_endian(header, (uint32_t) job.width);
+  put_big_endian(header, (uint32_t) job.height);
+  header.push_back(8); // bits per sample
+  header.push_back(2); // truecolor
+  header.push_back(0); // deflate
+  header.push_back(0); // adaptive filtering
+  header.push_back(0); // not interlaced
+
+  static const unsigned char signature[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+  std::vector<unsigned char> png(signature, signature + 8);
+  put_chunk(png, "IHDR", header);
+  put_chunk(png, "IDAT", zlib);
+  put_chunk(png, "IEND", std::vector<unsigned char>());
+
+  char name[4096];
+  snprintf(name, sizeof(name), output.c_str(), (int) job.sequence);
+  FILE *file = fopen(name, "wb");
+  if(!file){
+    if(failed++ == 0){
+      fprintf(stderr, "Error: cannot write %s\n", name);
+    }
+    return;
+  }
+  const bool complete = fwrite(&png[0], 1, png.size(), file) == png.size();
+  if(fclose(file) != 0 || !complete){
+    failed++;
+    return;
+  }
+  written++;
+}
+
+static void
+write_video_frame(const capture_job &job)
+{
+  // BT.601, studio range, top row first, in three planes
+  const size_t pixels = (size_t) job.width * job.height;
+  std::vector<unsigned char> yuv(3 * pixels);
+  for(int y = 0; y < job.height; y++){
+    const unsigned char *from = &job.rgba[4 * (size_t) job.width * (job.height - 1 - y)];
+    for(int x = 0; x < job.width; x++){
+      const int r = from[0], g = from[1], b = from[2];
+      const size_t i = (size_t) job.width * y + x;
+      yuv[i] = (unsigned char) (16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+      yuv[pixels + i] = (unsigned char) (128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+      yuv[2 * pixels + i] = (unsigned char) (128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+      from += 4;
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(video_mutex);
+  video_turn.wait(lock, [&]{ return next_to_write == job.sequence; });
+  if(video_width == 0){
+    video_width = job.width;
+    video_height = job.height;
+    fprintf(video_file,
+            "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n",
+            video_width,
+            video_height,
+            video_fps);
+  }
+  if(job.width != video_width || job.height != video_height){
+    // a stream has one size; the window was resized
+    failed++;
+  }
+  else if(fputs("FRAME\n", video_file) < 0
+          || fwrite(&yuv[0], 1, yuv.size(), video_file) != yuv.size()){
+    failed++;
+  }
+  else{
+    written++;
+  }
+  next_to_write++;
+  video_turn.notify_all();
+}
+
+static void
+work()
+{
+  timeline_name_thread("capture");
+  for(;;){
+    capture_job job;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      queue_changed.wait(lock, []{ return finishing || !queue.empty(); });
+      if(queue.empty()){
+        return;
+      }
+      job = std::move(queue.front());
+      queue.pop_front();
+    }
+    timeline_zone zone("encode frame");
+    if(video){
+      write_video_frame(job);
+    }
+    else{
+      write_png(job);
+    }
+  }
+}
+
+bool
+frame_capture_init()
+{
+  if(!GLEW_VERSION_2_1 && !GLEW_ARB_pixel_buffer_object){
+    fprintf(stderr,
+            "Error: MVP_CAPTURE requires OpenGL 2.1 or GL_ARB_pixel_buffer_object\n");
+    return false;
+  }
+  output = option_string("CAPTURE", "");
+  video = ends_with(output, ".y4m");
+  if(video){
+    video_fps = option_int("CAPTURE_FPS", 60);
+    if(video_fps < 1){
+      video_fps = 1;
+    }
+    if(!(video_file = fopen(output.c_str(), "wb"))){
+      fprintf(stderr, "Error: cannot write %s\n", output.c_str());
+      return false;
+    }
+  }
+  else if(!one_frame_number(output)){
+    fprintf(stderr,
+            "Error: MVP_CAPTURE must end in .y4m, or contain one %%d for the frame number\n");
+    return false;
+  }
+
+  int number_of_slots = option_int("CAPTURE_BUFFERS", 3);
+  if(number_of_slots < 1){
+    number_of_slots = 1;
+  }
+  slots.resize(number_of_slots);
+  for(size_t s = 0; s < slots.size(); s++){
+    glGenBuffers(1, &slots[s].buffer);
+    slots[s].capacity = 0;
+    slots[s].fence = 0;
+    slots[s].pending = false;
+  }
+  const int queue_option = option_int("CAPTURE_QUEUE", 16);
+  queue_limit = queue_option < 1 ? 1 : (size_t) queue_option;
+
+  int threads = option_int("CAPTURE_THREADS", 2);
+  if(threads < 1){
+    threads = 1;
+  }
+  for(int t = 0; t < threads; t++){
+    workers.push_back(std::thread(work));
+  }
+  active = true;
+  return true;
+}
+
+// map a slot whose read was issued a ring ago, and queue its pixels
+static void
+collect(capture_slot &slot,
+        bool may_drop)
+{
+  slot.pending = false;
+  if(slot.fence){
+    if(glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED){
+      gpu_waits++;
+      glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = 0;
+  }
+  if(may_drop){
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    if(queue.size() >= queue_limit){
+      dropped++;
+      return;
+    }
+  }
+  capture_job job;
+  job.width = slot.width;
+  job.height = slot.height;
+  const size_t size = 4 * (size_t) slot.width * slot.height;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  const unsigned char *pixels =
+    (const unsigned char *) glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+  if(pixels){
+    job.rgba.assign(pixels, pixels + size);
+  }
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if(!pixels){
+    failed++;
+    return;
+  }
+  job.sequence = sequence++;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    queue.push_back(std::move(job));
+  }
+  queue_changed.notify_one();
+}
+
+void
+frame_capture_end_frame(int width,
+                        int height)
+{
+  if(!active || width <= 0 || height <= 0){
+    return;
+  }
+  timeline_zone zone("capture");
+  capture_slot &slot = slots[next_slot];
+  if(slot.pending){
+    collect(slot, /*may_drop*/ true);
+  }
+  const GLsizeiptr size = 4 * (GLsizeiptr) width * height;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  if(slot.capacity < size){
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+    slot.capacity = size;
+  }
+  // into the buffer object; returns without waiting for the frame
+  glReadPixels(0, 0,
+               width, height,
+               GL_RGBA,
+               GL_UNSIGNED_BYTE,
+               /*offset*/ 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if(GLEW_ARB_sync){
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+  slot.width = width;
+  slot.height = height;
+  slot.pending = true;
+  next_slot = (next_slot + 1) % slots.size();
+  frames_read++;
+}
+
+void
+frame_capture_shutdown()
+{
+  if(!active){
+    return;
+  }
+  // oldest first
+  for(size_t s = 0; s < slots.size(); s++){
+    capture_slot &slot = slots[(next_slot + s) % slots.size()];
+    if(slot.pending){
+      collect(slot, /*may_drop*/ false);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    finishing = true;
+  }
+  queue_changed.notify_all();
+  for(size_t t = 0; t < workers.size(); t++){
+    workers[t].join();
+  }
+  workers.clear();
+  if(video_file){
+    fclose(video_file);
+    video_file = NULL;
+  }
+  for(size_t s = 0; s < slots.size(); s++){
+    glDeleteBuffers(1, &slots[s].buffer);
+  }
+  slots.clear();
+  active = false;
+}
+
+void
+frame_capture_report()
+{
+  if(frames_read == 0){
+    return;
+  }
+  fprintf(stderr,
+          "frame capture: %lu frames read, %lu written, %lu dropped, %lu failed, "
+          "waited for the GPU %lu times\n",
+          frames_read,
+          written.load(),
+          dropped,
+          failed.load(),
+          gpu_waits);
+}
@@ -0,0 +1,61 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Recording every frame, without slowing the frames down.
+ *
+ * Reading the framebuffer with "glReadPixels" into client memory
+ * waits until the GPU has finished drawing the frame.  Instead, each
+ * frame is read into the next of MVP_CAPTURE_BUFFERS pixel buffer
+ * objects (default 3), which returns at once, and a fence is placed
+ * after the read.  A buffer is mapped only when the ring comes back
+ * around to it, that many frames later, by which time the read has
+ * long finished.  Its pixels are copied out and handed to
+ * MVP_CAPTURE_THREADS worker threads (default 2) to be encoded.
+ *
+ * MVP_CAPTURE names the output.  If it ends in ".y4m", the frames are
+ * written, in order, as an uncompressed YUV4MPEG2 video at
+ * MVP_CAPTURE_FPS frames per second (default 60), in 4:4:4 so that no
+ * color is lost.  Otherwise it is a printf pattern for one PNG still
+ * per frame, e.g. "frame%05d.png", with exactly one "%d", whose image
+ * data is stored without compression.
+ *
+ * If the workers fall behind by more than MVP_CAPTURE_QUEUE frames
+ * (default 16), a frame is dropped rather than blocking the event
+ * loop.  The numbers of frames written and dropped are printed at
+ * exit.  Requires OpenGL 2.1 or GL_ARB_pixel_buffer_object.
+ */
+
+bool
+frame_capture_requested();
+
+/* create the buffers and start the workers.  Requires a current
+ * context.  Returns false, after printing the reason to stderr, on
+ * failure
+ */
+bool
+frame_capture_init();
+
+/* call once per frame, after drawing and before "glfwSwapBuffers",
+ * with the size of the framebuffer
+ */
+void
+frame_capture_end_frame(int width,
+                        int height);
+
+/* encode the frames still in flight, and stop the workers.  Requires
+ * the context to be current
+ */
+void
+frame_capture_shutdown();
+
+void
+frame_capture_report();
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include "main.h"
+#include "options.h"
+#include "timeline.h"
+#include "frame_pacing.h"
+
+typedef std::chrono::steady_clock pacing_clock;
+
+static double target_period = 0.0; // seconds, 0 means unlimited
+static pacing_clock::duration spin_duration;
+static pacing_clock::time_point deadline;
+static pacing_clock::time_point previous_frame;
+static bool first_frame = true;
+static unsigned long late_frames = 0;
+
+// the frames' intervals, in seconds, summarized in constant space, as
+// a kiosk may run for months
+static unsigned long intervals = 0;
+static double interval_sum = 0.0;
+static double interval_squares = 0.0;
+static double shortest = 0.0;
+static double longest = 0.0;
+// for the percentile: buckets 1% apart, from 10 us to about 11 s
+static const double histogram_low = 1e-5;
+static const double bucket_ratio = 1.01;
+static const int number_of_buckets = 1400;
+static unsigned long histogram[number_of_buckets];
+
+static void
+record_interval(double seconds)
+{
+  if(intervals == 0 || seconds < shortest){
+    shortest = seconds;
+  }
+  if(intervals == 0 || seconds > longest){
+    longest = seconds;
+  }
+  intervals++;
+  interval_sum += seconds;
+  interval_squares += seconds * seconds;
+  int bucket = 0;
+  if(seconds > histogram_low){
+    bucket = std::min(number_of_buckets - 1,
+                      (int) (std::log(seconds / histogram_low) / std::log(bucket_ratio)));
+  }
+  histogram[bucket]++;
+}
+
+// the interval which "fraction" of the intervals are no longer than,
+// to within a bucket
+static double
+percentile(double fraction)
+{
+  const unsigned long rank = (unsigned long) ((intervals - 1) * fraction);
+  unsigned long seen = 0;
+  int bucket = 0;
+  for(; bucket < number_of_buckets - 1; bucket++){
+    seen += histogram[bucket];
+    if(seen > rank){
+      break;
+    }
+  }
+  // the middle of the bucket, but never beyond what was measured
+  const double middle = histogram_low * std::pow(bucket_ratio, bucket + 0.5);
+  return std::max(shortest, std::min(longest, middle));
+}
+
+void
+frame_pacing_init()
+{
+  const char *vsync = option_string("VSYNC", "on");
+  int interval = 1;
+  if(0 == strcmp(vsync, "off") || 0 == strcmp(vsync, "0")){
+    interval = 0;
+  }
+  else if(0 == strcmp(vsync, "adaptive")){
+    if(glfwExtensionSupported("GLX_EXT_swap_control_tear")
+       || glfwExtensionSupported("WGL_EXT_swap_control_tear")){
+      interval = -1;
+    }
+    else{
+      fprintf(stderr, "Adaptive vsync is unsupported, using vsync\n");
+    }
+  }
+  glfwSwapInterval(interval);
+
+  const double fps = option_double("FPS", 0.0);
+  target_period = (fps > 0.0) ? 1.0 / fps : 0.0;
+  spin_duration = std::chrono::duration_cast<pacing_clock::duration>
+    (std::chrono::microseconds(option_int("FRAME_SPIN_US", 2000)));
+}
+
+// sleep for most of the time until "until", and spin for the rest
+static void
+wait_until(pacing_clock::time_point until)
+{
+  pacing_clock::time_point now = pacing_clock::now();
+  if(until - now > spin_duration){
+    std::this_thread::sleep_for(until - now - spin_duration);
+  }
+  while(pacing_clock::now() < until){
+    // spin
+  }
+}
+
+void
+frame_pacing_end_frame()
+{
+  if(target_period > 0.0){
+    const pacing_clock::duration period =
+      std::chrono::duration_cast<pacing_clock::duration>
+      (std::chrono::duration<double>(target_period));
+    if(first_frame){
+      deadline = pacing_clock::now();
+    }
+    deadline += period;
+    const pacing_clock::time_point now = pacing_clock::now();
+    if(now > deadline){
+      // a late frame; don't try to catch up by rushing the next ones
+      late_frames++;
+      deadline = now;
+    }
+    else{
+      timeline_zone zone("pace");
+      wait_until(deadline);
+    }
+  }
+  const pacing_clock::time_point now = pacing_clock::now();
+  if(!first_frame){
+    record_interval(std::chrono::duration<double>(now - previous_frame).count());
+  }
+  previous_frame = now;
+  first_frame = false;
+}
+
+void
+frame_pacing_idle()
+{
+  first_frame = true;
+}
+
+void
+frame_pacing_report()
+{
+  if(intervals == 0){
+    return;
+  }
+  const double mean = interval_sum / intervals;
+  // jitter is measured against the target period if there is one,
+  // otherwise against the mean interval
+  const double expected = (target_period > 0.0) ? target_period : mean;
+  // the sum of (interval - expected)^2, expanded
+  const double squared_deviation = std::max(0.0,
+                                            interval_squares
+                                            - 2.0 * expected * interval_sum
+                                            + intervals * expected * expected);
+  fprintf(stderr,
+          "frame pacing: %lu frames, mean %.3f ms (%.1f fps), "
+          "jitter %.3f ms rms, min %.3f ms, p99 %.3f ms, max %.3f ms",
+          intervals,
+          mean * 1000.0,
+          1.0 / mean,
+          sqrt(squared_deviation / intervals) * 1000.0,
+          shortest * 1000.0,
+          percentile(0.99) * 1000.0,
+          longest * 1000.0);
+  if(target_period > 0.0){
+    fprintf(stderr, ", %lu late", late_frames);
+  }
+  fprintf(stderr, "\n");
+}
@@ -0,0 +1,46 @@
+#ifndef FRAME_PACING_H
+#define FRAME_PACING_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Frame pacing.
+ *
+ * MVP_VSYNC selects the swap interval: "on" (the default) waits for
+ * the monitor's vertical refresh, "off" does not, and "adaptive"
+ * waits unless the frame is already late, in which case it swaps
+ * immediately (requires *_EXT_swap_control_tear).
+ *
+ * MVP_FPS, if set, caps the framerate.  The limiter sleeps until
+ * shortly before the frame's deadline, then spins for the remaining
+ * MVP_FRAME_SPIN_US microseconds, since the operating system's sleep
+ * is too coarse on its own.
+ *
+ * Every frame's interval is recorded, in constant space, and the
+ * pacing jitter is printed to stderr at exit.
+ */
+
+/* set the swap interval of the current context */
+void
+frame_pacing_init();
+
+/* call once per frame, after "glfwSwapBuffers"; waits for the
+ * framerate limit, if any, and records the frame's interval
+ */
+void
+frame_pacing_end_frame();
+
+/* call after the event loop has slept, so that the time asleep is not
+ * counted as a frame's interval
+ */
+void
+frame_pacing_idle();
+
+void
+frame_pacing_report();
+
+#endif
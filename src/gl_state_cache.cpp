@@ -0,0 +1,295 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <cstdio>
+// calls made here go down to the driver, never back up through the layers above
+#define QUAD_BATCH_IMPLEMENTATION 1
+#define SPLIT_SCREEN_IMPLEMENTATION 1
+#define GL_STATE_CACHE_IMPLEMENTATION 1
+#include "main.h"
+#include "options.h"
+
+enum cached_call {
+  CALL_ENABLE,
+  CALL_DISABLE,
+  CALL_CLEAR_COLOR,
+  CALL_CLEAR_DEPTH,
+  CALL_DEPTH_FUNC,
+  CALL_BLEND_FUNC,
+  CALL_COLOR_3F,
+  CALL_VIEWPORT,
+  CALL_SCISSOR,
+  NUMBER_OF_CACHED_CALLS
+};
+
+static const char *call_names[NUMBER_OF_CACHED_CALLS] = {
+  "glEnable",
+  "glDisable",
+  "glClearColor",
+  "glClearDepth",
+  "glDepthFunc",
+  "glBlendFunc",
+  "glColor3f",
+  "glViewport",
+  "glScissor"
+};
+
+static unsigned long issued[NUMBER_OF_CACHED_CALLS];
+static unsigned long skipped[NUMBER_OF_CACHED_CALLS];
+
+// the capabilities enabled or disabled so far.  Unknown capabilities
+// are not cached, in case they are changed by code outside of the cache
+static const int capacity = 16;
+static GLenum capabilities[capacity];
+static bool capability_enabled[capacity];
+static int number_of_capabilities = 0;
+
+static bool clear_color_known = false;
+static GLclampf clear_color[4];
+static bool clear_depth_known = false;
+static GLclampd clear_depth;
+static bool depth_func_known = false;
+static GLenum depth_func;
+static bool blend_func_known = false;
+static GLenum blend_func[2];
+static bool color_known = false;
+static GLfloat color[3];
+static bool viewport_known = false;
+static GLint viewport[4];
+static bool scissor_known = false;
+static GLint scissor[4];
+
+static bool
+caching()
+{
+  static const bool result = option_string("STATE_CACHE", NULL) == NULL
+    || option_enabled("STATE_CACHE");
+  return result;
+}
+
+// true if the call must be issued.  Counts the call either way
+static bool
+must_issue(cached_call call,
+           bool redundant)
+{
+  if(redundant){
+    skipped[call]++;
+    if(caching()){
+      return false;
+    }
+  }
+  issued[call]++;
+  return true;
+}
+
+static void
+enable_or_disable(GLenum cap,
+                  bool enable)
+{
+  int i = 0;
+  while(i < number_of_capabilities && capabilities[i] != cap){
+    i++;
+  }
+  const bool known = i < number_of_capabilities;
+  if(!must_issue(enable ? CALL_ENABLE : CALL_DISABLE,
+                 known && capability_enabled[i] == enable)){
+    return;
+  }
+  if(enable){
+    glEnable(cap);
+  }
+  else{
+    glDisable(cap);
+  }
+  if(!known && number_of_capabilities < capacity){
+    capabilities[number_of_capabilities++] = cap;
+  }
+  if(i < number_of_capabilities){
+    capability_enabled[i] = enable;
+  }
+}
+
+void
+state_cache_glEnable(GLenum cap)
+{
+  enable_or_disable(cap, true);
+}
+
+void
+state_cache_glDisable(GLenum cap)
+{
+  enable_or_disable(cap, false);
+}
+
+void
+state_cache_glClearColor(GLclampf red,
+                         GLclampf green,
+                         GLclampf blue,
+                         GLclampf alpha)
+{
+  if(!must_issue(CALL_CLEAR_COLOR,
+                 clear_color_known
+                 && clear_color[0] == red
+                 && clear_color[1] == green
+                 && clear_color[2] == blue
+                 && clear_color[3] == alpha)){
+    return;
+  }
+  glClearColor(red, green, blue, alpha);
+  clear_color[0] = red;
+  clear_color[1] = green;
+  clear_color[2] = blue;
+  clear_color[3] = alpha;
+  clear_color_known = true;
+}
+
+void
+state_cache_glClearDepth(GLclampd depth)
+{
+  if(!must_issue(CALL_CLEAR_DEPTH,
+                 clear_depth_known && clear_depth == depth)){
+    return;
+  }
+  glClearDepth(depth);
+  clear_depth = depth;
+  clear_depth_known = true;
+}
+
+void
+state_cache_glDepthFunc(GLenum func)
+{
+  if(!must_issue(CALL_DEPTH_FUNC,
+                 depth_func_known && depth_func == func)){
+    return;
+  }
+  glDepthFunc(func);
+  depth_func = func;
+  depth_func_known = true;
+}
+
+void
+state_cache_glBlendFunc(GLenum sfactor,
+                        GLenum dfactor)
+{
+  if(!must_issue(CALL_BLEND_FUNC,
+                 blend_func_known
+                 && blend_func[0] == sfactor
+                 && blend_func[1] == dfactor)){
+    return;
+  }
+  glBlendFunc(sfactor, dfactor);
+  blend_func[0] = sfactor;
+  blend_func[1] = dfactor;
+  blend_func_known = true;
+}
+
+void
+state_cache_glColor3f(GLfloat red,
+                      GLfloat green,
+                      GLfloat blue)
+{
+  if(!must_issue(CALL_COLOR_3F,
+                 color_known
+                 && color[0] == red
+                 && color[1] == green
+                 && color[2] == blue)){
+    return;
+  }
+  glColor3f(red, green, blue);
+  color[0] = red;
+  color[1] = green;
+  color[2] = blue;
+  color_known = true;
+}
+
+void
+state_cache_glViewport(GLint x,
+                       GLint y,
+                       GLsizei width,
+                       GLsizei height)
+{
+  if(!must_issue(CALL_VIEWPORT,
+                 viewport_known
+                 && viewport[0] == x
+                 && viewport[1] == y
+                 && viewport[2] == width
+                 && viewport[3] == height)){
+    return;
+  }
+  glViewport(x, y, width, height);
+  viewport[0] = x;
+  viewport[1] = y;
+  viewport[2] = width;
+  viewport[3] = height;
+  viewport_known = true;
+}
+
+void
+state_cache_glScissor(GLint x,
+                      GLint y,
+                      GLsizei width,
+                      GLsizei height)
+{
+  if(!must_issue(CALL_SCISSOR,
+                 scissor_known
+                 && scissor[0] == x
+                 && scissor[1] == y
+                 && scissor[2] == width
+                 && scissor[3] == height)){
+    return;
+  }
+  glScissor(x, y, width, height);
+  scissor[0] = x;
+  scissor[1] = y;
+  scissor[2] = width;
+  scissor[3] = height;
+  scissor_known = true;
+}
+
+void
+gl_state_cache_invalidate()
+{
+  number_of_capabilities = 0;
+  clear_color_known = false;
+  clear_depth_known = false;
+  depth_func_known = false;
+  blend_func_known = false;
+  color_known = false;
+  viewport_known = false;
+  scissor_known = false;
+}
+
+void
+gl_state_cache_forget_color()
+{
+  color_known = false;
+}
+
+void
+gl_state_cache_report()
+{
+  if(!option_enabled("STATE_CACHE_STATS")){
+    return;
+  }
+  unsigned long total_issued = 0;
+  unsigned long total_skipped = 0;
+  fprintf(stderr, "state cache:%s\n", caching() ? "" : " (disabled)");
+  for(int call = 0; call < NUMBER_OF_CACHED_CALLS; call++){
+    fprintf(stderr,
+            "  %-14s %10lu issued %10lu redundant\n",
+            call_names[call],
+            issued[call],
+            skipped[call]);
+    total_issued += issued[call];
+    total_skipped += skipped[call];
+  }
+  fprintf(stderr,
+          "  %-14s %10lu issued %10lu redundant\n",
+          "total",
+          total_issued,
+          total_skipped);
+}
@@ -0,0 +1,109 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Redundant OpenGL state-change elimination.
+ *
+ * The book sets the same state over and over: the clear color is
+ * changed twice per frame by "draw_in_square_viewport", depth testing
+ * is enabled every frame from chapter 15 onwards, and "glColor3f" is
+ * frequently called with the color which is already current.  Every
+ * such call costs a trip into the driver.
+ *
+ * Once this header is included (main.h does so), calls to the
+ * procedures below are routed through a cache of the current state,
+ * and calls which would not change that state are skipped.  The
+ * number of calls skipped is printed at exit if MVP_STATE_CACHE_STATS=1.
+ * MVP_STATE_CACHE=0 disables the skipping, but not the counting.
+ *
+ * Like every layer over the driver, the macros below leave alone any
+ * procedure which a layer included earlier already redirects.
+ *
+ * The cache assumes that it sees every change to the state it tracks.
+ * Code which changes that state behind its back (e.g. "glPopAttrib",
+ * or drawing with a color array, which leaves the current color
+ * undefined) must call "gl_state_cache_invalidate".
+ */
+
+void
+state_cache_glEnable(GLenum cap);
+void
+state_cache_glDisable(GLenum cap);
+void
+state_cache_glClearColor(GLclampf red,
+                         GLclampf green,
+                         GLclampf blue,
+                         GLclampf alpha);
+void
+state_cache_glClearDepth(GLclampd depth);
+void
+state_cache_glDepthFunc(GLenum func);
+void
+state_cache_glBlendFunc(GLenum sfactor,
+                        GLenum dfactor);
+void
+state_cache_glColor3f(GLfloat red,
+                      GLfloat green,
+                      GLfloat blue);
+void
+state_cache_glViewport(GLint x,
+                       GLint y,
+                       GLsizei width,
+                       GLsizei height);
+void
+state_cache_glScissor(GLint x,
+                      GLint y,
+                      GLsizei width,
+                      GLsizei height);
+
+/* forget everything, so that the next call of each is issued */
+void
+gl_state_cache_invalidate();
+
+/* forget only the current color */
+void
+gl_state_cache_forget_color();
+
+void
+gl_state_cache_report();
+
+#ifndef GL_STATE_CACHE_IMPLEMENTATION
+#ifndef glEnable
+#define glEnable(cap) state_cache_glEnable(cap)
+#endif
+#ifndef glDisable
+#define glDisable(cap) state_cache_glDisable(cap)
+#endif
+#ifndef glClearColor
+#define glClearColor(red, green, blue, alpha) \
+  state_cache_glClearColor(red, green, blue, alpha)
+#endif
+#ifndef glClearDepth
+#define glClearDepth(depth) state_cache_glClearDepth(depth)
+#endif
+#ifndef glDepthFunc
+#define glDepthFunc(func) state_cache_glDepthFunc(func)
+#endif
+#ifndef glBlendFunc
+#define glBlendFunc(sfactor, dfactor) state_cache_glBlendFunc(sfactor, dfactor)
+#endif
+#ifndef glColor3f
+#define glColor3f(red, green, blue) state_cache_glColor3f(red, green, blue)
+#endif
+#ifndef glViewport
+#define glViewport(x, y, width, height) \
+  state_cache_glViewport(x, y, width, height)
+#endif
+#ifndef glScissor
+#define glScissor(x, y, width, height) \
+  state_cache_glScissor(x, y, width, height)
+#endif
+#endif
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <stdint.h>
+// this file calls the driver directly; no layer may redirect its calls
+#define QUAD_BATCH_IMPLEMENTATION 1
+#define SPLIT_SCREEN_IMPLEMENTATION 1
+#define GL_STATE_CACHE_IMPLEMENTATION 1
+#define GL_TRACE_IMPLEMENTATION 1
+#include "main.h"
+#include "options.h"
+
+#ifdef ENABLE_GL_TRACE
+
+typedef std::chrono::steady_clock trace_clock;
+
+enum entry_point {
+#define GL_TRACE_ENUM_DIRECT(ret, name, params, args) TRACE_##name,
+#define GL_TRACE_ENUM_GLEW(ret, name, pointer, params, args) TRACE_##name,
+  GL_TRACE_DIRECT_ENTRY_POINTS(GL_TRACE_ENUM_DIRECT)
+  GL_TRACE_GLEW_ENTRY_POINTS(GL_TRACE_ENUM_GLEW)
+#undef GL_TRACE_ENUM_DIRECT
+#undef GL_TRACE_ENUM_GLEW
+  NUMBER_OF_ENTRY_POINTS
+};
+
+static const char *entry_point_names[NUMBER_OF_ENTRY_POINTS] = {
+#define GL_TRACE_NAME_DIRECT(ret, name, params, args) #name,
+#define GL_TRACE_NAME_GLEW(ret, name, pointer, params, args) #name,
+  GL_TRACE_DIRECT_ENTRY_POINTS(GL_TRACE_NAME_DIRECT)
+  GL_TRACE_GLEW_ENTRY_POINTS(GL_TRACE_NAME_GLEW)
+#undef GL_TRACE_NAME_DIRECT
+#undef GL_TRACE_NAME_GLEW
+};
+
+// this frame
+static unsigned long frame_calls[NUMBER_OF_ENTRY_POINTS];
+static trace_clock::duration frame_time[NUMBER_OF_ENTRY_POINTS];
+// all frames
+static unsigned long frames = 0;
+static unsigned long long total_calls[NUMBER_OF_ENTRY_POINTS];
+static trace_clock::duration total_time[NUMBER_OF_ENTRY_POINTS];
+static unsigned long max_calls[NUMBER_OF_ENTRY_POINTS];
+
+struct trace_record {
+  uint16_t entry_point;
+  uint16_t zero;
+  uint32_t duration_ns;
+  uint64_t start_ns;
+};
+
+static long frame_to_dump = -1;
+static trace_clock::time_point frame_start = trace_clock::now();
+static std::vector<trace_record> records;
+
+// times one call to the driver, from construction to destruction
+class traced_call {
+public:
+  traced_call(entry_point the_entry_point):
+    entry(the_entry_point),
+    start(trace_clock::now())
+  {}
+  ~traced_call()
+  {
+    const trace_clock::time_point end = trace_clock::now();
+    frame_calls[entry]++;
+    frame_time[entry] += end - start;
+    if((long) frames == frame_to_dump){
+      trace_record r;
+      r.entry_point = (uint16_t) entry;
+      r.zero = 0;
+      r.duration_ns = (uint32_t) std::chrono::duration_cast
+        <std::chrono::nanoseconds>(end - start).count();
+      r.start_ns = (uint64_t) std::chrono::duration_cast
+        <std::chrono::nanoseconds>(start - frame_start).count();
+      records.push_back(r);
+    }
+  }
+private:
+  entry_point entry;
+  trace_clock::time_point start;
+};
+
+#define GL_TRACE_DEFINE_DIRECT(ret, name, params, args)        \
+  ret GLAPIENTRY gl_trace_##name params                        \
+  {                                                            \
+    traced_call call(TRACE_##name);                            \
+    return name args;                                          \
+  }
+GL_TRACE_DIRECT_ENTRY_POINTS(GL_TRACE_DEFINE_DIRECT)
+#undef GL_TRACE_DEFINE_DIRECT
+
+// GLEW's original function pointers, and their replacements
+#define GL_TRACE_DEFINE_GLEW(ret, name, pointer, params, args)  \
+  static decltype(pointer) real_##name = NULL;                  \
+  static ret GLAPIENTRY traced_##name params                    \
+  {                                                             \
+    traced_call call(TRACE_##name);                             \
+    return real_##name args;                                    \
+  }
+GL_TRACE_GLEW_ENTRY_POINTS(GL_TRACE_DEFINE_GLEW)
+#undef GL_TRACE_DEFINE_GLEW
+
+void
+gl_trace_init()
+{
+  // procedures the driver does not provide stay NULL
+#define GL_TRACE_REPLACE_GLEW(ret, name, pointer, params, args) \
+  if(pointer != NULL){                                          \
+    real_##name = pointer;                                      \
+    pointer = traced_##name;                                    \
+  }
+  GL_TRACE_GLEW_ENTRY_POINTS(GL_TRACE_REPLACE_GLEW)
+#undef GL_TRACE_REPLACE_GLEW
+  frame_to_dump = option_int("GL_TRACE_FRAME", -1);
+}
+
+static void
+dump_records()
+{
+  const char *path = option_string("GL_TRACE_FILE", "gltrace.bin");
+  FILE *file = fopen(path, "wb");
+  if(file == NULL){
+    fprintf(stderr, "Error: could not write %s\n", path);
+    return;
+  }
+  fwrite("MVPGLTR1", 1, 8, file);
+  const uint32_t number_of_names = NUMBER_OF_ENTRY_POINTS;
+  fwrite(&number_of_names, sizeof(number_of_names), 1, file);
+  for(int i = 0; i < NUMBER_OF_ENTRY_POINTS; i++){
+    const uint16_t length = (uint16_t) strlen(entry_point_names[i]);
+    fwrite(&length, sizeof(length), 1, file);
+    fwrite(entry_point_names[i], 1, length, file);
+  }
+  const uint64_t number_of_calls = records.size();
+  fwrite(&number_of_calls, sizeof(number_of_calls), 1, file);
+  if(!records.empty()){
+    fwrite(&records[0], sizeof(trace_record), records.size(), file);
+  }
+  fclose(file);
+  fprintf(stderr, "gl trace: wrote %lu calls of frame %ld to %s\n",
+          (unsigned long) records.size(), frame_to_dump, path);
+  records.clear();
+}
+
+void
+gl_trace_end_frame()
+{
+  for(int i = 0; i < NUMBER_OF_ENTRY_POINTS; i++){
+    total_calls[i] += frame_calls[i];
+    total_time[i] += frame_time[i];
+    if(frame_calls[i] > max_calls[i]){
+      max_calls[i] = frame_calls[i];
+    }
+    frame_calls[i] = 0;
+    frame_time[i] = trace_clock::duration::zero();
+  }
+  if((long) frames == frame_to_dump){
+    dump_records();
+  }
+  frames++;
+  frame_start = trace_clock::now();
+}
+
+void
+gl_trace_report()
+{
+  if(frames == 0){
+    return;
+  }
+  fprintf(stderr,
+          "gl trace: %lu frames\n"
+          "  %-22s %12s %10s %14s %12s\n",
+          frames,
+          "entry point",
+          "calls/frame",
+          "max/frame",
+          "us/frame",
+          "ns/call");
+  unsigned long long calls = 0;
+  trace_clock::duration time = trace_clock::duration::zero();
+  for(int i = 0; i < NUMBER_OF_ENTRY_POINTS; i++){
+    if(total_calls[i] == 0){
+      continue;
+    }
+    const double nanoseconds = (double) std::chrono::duration_cast
+      <std::chrono::nanoseconds>(total_time[i]).count();
+    fprintf(stderr,
+            "  %-22s %12.1f %10lu %14.2f %12.1f\n",
+            entry_point_names[i],
+            (double) total_calls[i] / frames,
+            max_calls[i],
+            nanoseconds / 1000.0 / frames,
+            nanoseconds / total_calls[i]);
+    calls += total_calls[i];
+    time += total_time[i];
+  }
+  fprintf(stderr,
+          "  %-22s %12.1f %10s %14.2f\n",
+          "total",
+          (double) calls / frames,
+          "",
+          std::chrono::duration<double, std::micro>(time).count() / frames);
+}
+
+#endif /* ENABLE_GL_TRACE */
@@ -0,0 +1,231 @@
+#ifndef GL_TRACE_H
+#define GL_TRACE_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* OpenGL call tracing, built with "./configure --enable-gl-trace".
+ *
+ * Every call to the procedures listed below is counted and timed, per
+ * frame.  OpenGL 1.1 procedures are linked directly against the
+ * system's OpenGL library, so they are redirected by the macros at
+ * the end of this file; newer procedures are reached through GLEW's
+ * function pointers, which "gl_trace_init" replaces with tracing
+ * versions.
+ *
+ * At exit, the average number of calls and the average time spent in
+ * the driver, per frame, is printed for each procedure.  If
+ * MVP_GL_TRACE_FRAME=n is set, every call made during frame "n" is
+ * also written, in order, to the binary file MVP_GL_TRACE_FILE
+ * (default "gltrace.bin"):
+ *
+ *   "MVPGLTR1", uint32 number_of_names,
+ *   number_of_names * (uint16 length, name bytes),
+ *   uint64 number_of_calls,
+ *   number_of_calls * (uint16 name index, uint16 zero,
+ *                      uint32 duration in ns,
+ *                      uint64 start in ns, since the frame began)
+ *
+ * all in the machine's native byte order.
+ */
+
+/* return type, name, parameters, arguments */
+#define GL_TRACE_DIRECT_ENTRY_POINTS(X)                                 \
+  X(void, glBegin, (GLenum mode), (mode))                               \
+  X(void, glEnd, (), ())                                                \
+  X(void, glVertex2f, (GLfloat x, GLfloat y), (x, y))                   \
+  X(void, glVertex3f, (GLfloat x, GLfloat y, GLfloat z), (x, y, z))     \
+  X(void, glColor3f, (GLfloat r, GLfloat g, GLfloat b), (r, g, b))      \
+  X(void, glClear, (GLbitfield mask), (mask))                           \
+  X(void, glClearColor,                                                 \
+    (GLclampf r, GLclampf g, GLclampf b, GLclampf a), (r, g, b, a))     \
+  X(void, glClearDepth, (GLclampd depth), (depth))                      \
+  X(void, glDepthFunc, (GLenum func), (func))                           \
+  X(void, glEnable, (GLenum cap), (cap))                                \
+  X(void, glDisable, (GLenum cap), (cap))                               \
+  X(void, glBlendFunc, (GLenum s, GLenum d), (s, d))                    \
+  X(void, glViewport,                                                   \
+    (GLint x, GLint y, GLsizei w, GLsizei h), (x, y, w, h))             \
+  X(void, glScissor,                                                    \
+    (GLint x, GLint y, GLsizei w, GLsizei h), (x, y, w, h))             \
+  X(void, glHint, (GLenum target, GLenum mode), (target, mode))         \
+  X(void, glMatrixMode, (GLenum mode), (mode))                          \
+  X(void, glLoadIdentity, (), ())                                       \
+  X(void, glPushMatrix, (), ())                                         \
+  X(void, glPopMatrix, (), ())                                          \
+  X(void, glTranslatef, (GLfloat x, GLfloat y, GLfloat z), (x, y, z))   \
+  X(void, glRotatef,                                                    \
+    (GLfloat a, GLfloat x, GLfloat y, GLfloat z), (a, x, y, z))         \
+  X(void, glScalef, (GLfloat x, GLfloat y, GLfloat z), (x, y, z))       \
+  X(void, glMultMatrixf, (const GLfloat *m), (m))                       \
+  X(void, glDrawArrays,                                                 \
+    (GLenum mode, GLint first, GLsizei count), (mode, first, count))    \
+  X(void, glDrawElements,                                               \
+    (GLenum mode, GLsizei count, GLenum type, const GLvoid *indices),   \
+    (mode, count, type, indices))                                       \
+  X(void, glVertexPointer,                                              \
+    (GLint size, GLenum type, GLsizei stride, const GLvoid *pointer),   \
+    (size, type, stride, pointer))                                      \
+  X(void, glColorPointer,                                               \
+    (GLint size, GLenum type, GLsizei stride, const GLvoid *pointer),   \
+    (size, type, stride, pointer))                                      \
+  X(void, glPushClientAttrib, (GLbitfield mask), (mask))                \
+  X(void, glPopClientAttrib, (), ())                                    \
+  X(void, glEnableClientState, (GLenum array), (array))                 \
+  X(void, glDisableClientState, (GLenum array), (array))
+
+/* return type, name, GLEW's function pointer, parameters, arguments */
+#define GL_TRACE_GLEW_ENTRY_POINTS(X)                                   \
+  X(void, glUseProgram, __glewUseProgram, (GLuint program), (program))  \
+  X(void, glUniformMatrix4fv, __glewUniformMatrix4fv,                   \
+    (GLint location, GLsizei count, GLboolean transpose,                \
+     const GLfloat *value),                                             \
+    (location, count, transpose, value))                                \
+  X(void, glUniform3f, __glewUniform3f,                                 \
+    (GLint location, GLfloat x, GLfloat y, GLfloat z),                  \
+    (location, x, y, z))                                                \
+  X(void, glBindVertexArray, __glewBindVertexArray,                     \
+    (GLuint array), (array))                                            \
+  X(void, glBindBuffer, __glewBindBuffer,                               \
+    (GLenum target, GLuint buffer), (target, buffer))                   \
+  X(GLsync, glFenceSync, __glewFenceSync,                               \
+    (GLenum condition, GLbitfield flags), (condition, flags))           \
+  X(GLenum, glClientWaitSync, __glewClientWaitSync,                     \
+    (GLsync sync, GLbitfield flags, GLuint64 timeout),                  \
+    (sync, flags, timeout))                                             \
+  X(void, glDeleteSync, __glewDeleteSync, (GLsync sync), (sync))
+
+#ifdef ENABLE_GL_TRACE
+
+#define GL_TRACE_DECLARE_DIRECT(ret, name, params, args)        \
+  ret GLAPIENTRY gl_trace_##name params;
+GL_TRACE_DIRECT_ENTRY_POINTS(GL_TRACE_DECLARE_DIRECT)
+#undef GL_TRACE_DECLARE_DIRECT
+
+/* replace GLEW's function pointers.  Call after "glewInit" */
+void
+gl_trace_init();
+
+/* call after the last OpenGL call of each frame */
+void
+gl_trace_end_frame();
+
+void
+gl_trace_report();
+
+/* Redirect the OpenGL 1.1 procedures, unless a layer included
+ * earlier (e.g. the state cache) already redirects them, in which case
+ * that layer's own calls to the driver are the ones redirected here.
+ */
+#ifndef GL_TRACE_IMPLEMENTATION
+#ifndef glBegin
+#define glBegin(mode) gl_trace_glBegin(mode)
+#endif
+#ifndef glEnd
+#define glEnd() gl_trace_glEnd()
+#endif
+#ifndef glVertex2f
+#define glVertex2f(x, y) gl_trace_glVertex2f(x, y)
+#endif
+#ifndef glVertex3f
+#define glVertex3f(x, y, z) gl_trace_glVertex3f(x, y, z)
+#endif
+#ifndef glColor3f
+#define glColor3f(r, g, b) gl_trace_glColor3f(r, g, b)
+#endif
+#ifndef glClear
+#define glClear(mask) gl_trace_glClear(mask)
+#endif
+#ifndef glClearColor
+#define glClearColor(r, g, b, a) gl_trace_glClearColor(r, g, b, a)
+#endif
+#ifndef glClearDepth
+#define glClearDepth(depth) gl_trace_glClearDepth(depth)
+#endif
+#ifndef glDepthFunc
+#define glDepthFunc(func) gl_trace_glDepthFunc(func)
+#endif
+#ifndef glEnable
+#define glEnable(cap) gl_trace_glEnable(cap)
+#endif
+#ifndef glDisable
+#define glDisable(cap) gl_trace_glDisable(cap)
+#endif
+#ifndef glBlendFunc
+#define glBlendFunc(s, d) gl_trace_glBlendFunc(s, d)
+#endif
+#ifndef glViewport
+#define glViewport(x, y, w, h) gl_trace_glViewport(x, y, w, h)
+#endif
+#ifndef glScissor
+#define glScissor(x, y, w, h) gl_trace_glScissor(x, y, w, h)
+#endif
+#ifndef glHint
+#define glHint(target, mode) gl_trace_glHint(target, mode)
+#endif
+#ifndef glMatrixMode
+#define glMatrixMode(mode) gl_trace_glMatrixMode(mode)
+#endif
+#ifndef glLoadIdentity
+#define glLoadIdentity() gl_trace_glLoadIdentity()
+#endif
+#ifndef glPushMatrix
+#define glPushMatrix() gl_trace_glPushMatrix()
+#endif
+#ifndef glPopMatrix
+#define glPopMatrix() gl_trace_glPopMatrix()
+#endif
+#ifndef glTranslatef
+#define glTranslatef(x, y, z) gl_trace_glTranslatef(x, y, z)
+#endif
+#ifndef glRotatef
+#define glRotatef(a, x, y, z) gl_trace_glRotatef(a, x, y, z)
+#endif
+#ifndef glScalef
+#define glScalef(x, y, z) gl_trace_glScalef(x, y, z)
+#endif
+#ifndef glMultMatrixf
+#define glMultMatrixf(m) gl_trace_glMultMatrixf(m)
+#endif
+#ifndef glDrawArrays
+#define glDrawArrays(mode, first, count) gl_trace_glDrawArrays(mode, first, count)
+#endif
+#ifndef glDrawElements
+#define glDrawElements(mode, count, type, indices) \
+  gl_trace_glDrawElements(mode, count, type, indices)
+#endif
+#ifndef glVertexPointer
+#define glVertexPointer(size, type, stride, pointer) \
+  gl_trace_glVertexPointer(size, type, stride, pointer)
+#endif
+#ifndef glColorPointer
+#define glColorPointer(size, type, stride, pointer) \
+  gl_trace_glColorPointer(size, type, stride, pointer)
+#endif
+#ifndef glPushClientAttrib
+#define glPushClientAttrib(mask) gl_trace_glPushClientAttrib(mask)
+#endif
+#ifndef glPopClientAttrib
+#define glPopClientAttrib() gl_trace_glPopClientAttrib()
+#endif
+#ifndef glEnableClientState
+#define glEnableClientState(array) gl_trace_glEnableClientState(array)
+#endif
+#ifndef glDisableClientState
+#define glDisableClientState(array) gl_trace_glDisableClientState(array)
+#endif
+#endif /* GL_TRACE_IMPLEMENTATION */
+
+#else /* ENABLE_GL_TRACE */
+
+inline void gl_trace_init() {}
+inline void gl_trace_end_frame() {}
+inline void gl_trace_report() {}
+
+#endif /* ENABLE_GL_TRACE */
+
+#endif
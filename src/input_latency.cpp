@@ -0,0 +1,185 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+#include "main.h"
+#include "options.h"
+#include "input_latency.h"
+
+typedef std::chrono::steady_clock latency_clock;
+
+struct key_event {
+  latency_clock::time_point received;
+  unsigned long frame_received;
+  // with the render thread, the step which first reflects the key
+  unsigned long step;
+};
+
+// keys received, but not yet seen by a frame
+static std::vector<key_event> pending;
+// keys which the frame being rendered is the first to reflect
+static std::vector<key_event> in_flight;
+// which may be presented by the render thread
+static std::atomic<unsigned long> frames_presented(0);
+// keys passed to the render thread, with the steps which reflect them
+static std::mutex handed_off_mutex;
+static std::vector<key_event> handed_off;
+
+// latency in milliseconds, and in frames
+static std::vector<float> latencies;
+static std::vector<unsigned long> frame_latencies;
+
+static const int histogram_buckets = 50; // 1 millisecond each
+
+static bool
+enabled()
+{
+  static const bool result = option_enabled("INPUT_LATENCY");
+  return result;
+}
+
+bool
+input_latency_enabled()
+{
+  return enabled();
+}
+
+void
+input_latency_key_event(int key,
+                        int action)
+{
+  if(!enabled() || action == GLFW_RELEASE){
+    return;
+  }
+  key_event e;
+  e.received = latency_clock::now();
+  e.frame_received = frames_presented;
+  pending.push_back(e);
+}
+
+void
+input_latency_begin_frame()
+{
+  if(!enabled()){
+    return;
+  }
+  in_flight.insert(in_flight.end(), pending.begin(), pending.end());
+  pending.clear();
+}
+
+// the keys which the frame just presented was the first to reflect
+static void
+record(const std::vector<key_event> &keys)
+{
+  const latency_clock::time_point now = latency_clock::now();
+  const unsigned long frame = ++frames_presented;
+  for(size_t i = 0; i < keys.size(); i++){
+    latencies.push_back(std::chrono::duration<float, std::milli>
+                        (now - keys[i].received).count());
+    frame_latencies.push_back(frame - keys[i].frame_received);
+  }
+}
+
+void
+input_latency_frame_presented()
+{
+  if(!enabled()){
+    return;
+  }
+  record(in_flight);
+  in_flight.clear();
+}
+
+void
+input_latency_step_published(unsigned long step)
+{
+  if(!enabled()){
+    return;
+  }
+  std::lock_guard<std::mutex> lock(handed_off_mutex);
+  for(size_t i = 0; i < in_flight.size(); i++){
+    in_flight[i].step = step;
+    handed_off.push_back(in_flight[i]);
+  }
+  in_flight.clear();
+}
+
+void
+input_latency_step_presented(unsigned long step)
+{
+  if(!enabled()){
+    return;
+  }
+  std::vector<key_event> presented;
+  {
+    std::lock_guard<std::mutex> lock(handed_off_mutex);
+    // in the order they were published, so by step
+    size_t n = 0;
+    while(n < handed_off.size() && handed_off[n].step <= step){
+      n++;
+    }
+    presented.assign(handed_off.begin(), handed_off.begin() + n);
+    handed_off.erase(handed_off.begin(), handed_off.begin() + n);
+  }
+  record(presented);
+}
+
+void
+input_latency_report()
+{
+  if(!enabled() || latencies.empty()){
+    return;
+  }
+  std::vector<float> sorted(latencies);
+  std::sort(sorted.begin(), sorted.end());
+  double sum = 0.0;
+  double frames_sum = 0.0;
+  for(size_t i = 0; i < sorted.size(); i++){
+    sum += sorted[i];
+    frames_sum += frame_latencies[i];
+  }
+  const size_t n = sorted.size();
+  fprintf(stderr,
+          "input latency: %lu key events, mean %.2f ms (%.2f frames), "
+          "p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+          (unsigned long) n,
+          sum / n,
+          frames_sum / n,
+          sorted[(n - 1) / 2],
+          sorted[(size_t) ((n - 1) * 0.95)],
+          sorted[(size_t) ((n - 1) * 0.99)],
+          sorted.back());
+
+  std::vector<unsigned long> histogram(histogram_buckets + 1, 0);
+  for(size_t i = 0; i < n; i++){
+    const int bucket = (int) sorted[i];
+    histogram[std::min(bucket, histogram_buckets)]++;
+  }
+  const unsigned long tallest = *std::max_element(histogram.begin(),
+                                                  histogram.end());
+  for(int bucket = 0; bucket <= histogram_buckets; bucket++){
+    if(histogram[bucket] == 0){
+      continue;
+    }
+    if(bucket < histogram_buckets){
+      fprintf(stderr, "  %3d-%3d ms %8lu ", bucket, bucket + 1, histogram[bucket]);
+    }
+    else{
+      fprintf(stderr, "  >=%3d ms   %8lu ", bucket, histogram[bucket]);
+    }
+    const int width = (int) (40 * histogram[bucket] / tallest);
+    for(int i = 0; i < width; i++){
+      fputc('#', stderr);
+    }
+    fputc('\n', stderr);
+  }
+}
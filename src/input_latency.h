@@ -0,0 +1,57 @@
+#ifndef INPUT_LATENCY_H
+#define INPUT_LATENCY_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Input-to-photon latency.
+ *
+ * Each key press (or repeat) is timestamped when GLFW delivers it.
+ * The timestamps are handed to the next frame to be simulated, which
+ * is the first frame that can reflect the key, and the latency is
+ * recorded once that frame has been presented.  A histogram, in
+ * milliseconds, is printed to stderr at exit.
+ *
+ * With the render thread (see "render_thread.h"), the key is handed to
+ * the next step to be simulated, and its latency recorded once the
+ * render thread has presented a frame of that step, or a later one.
+ *
+ * Enabled by setting MVP_INPUT_LATENCY=1 in the environment.
+ */
+
+bool
+input_latency_enabled();
+
+/* call from the GLFW key callback */
+void
+input_latency_key_event(int key,
+                        int action);
+
+/* call immediately before the frame samples the keyboard */
+void
+input_latency_begin_frame();
+
+/* call once the frame is visible: when "glfwSwapBuffers" returns, or,
+ * without a visible window, when the frame's pixels have been read back
+ */
+void
+input_latency_frame_presented();
+
+/* with the render thread: call on the main thread once step number
+ * "step" has been published, and on the render thread once a frame
+ * drawn from that step has been presented
+ */
+void
+input_latency_step_published(unsigned long step);
+
+void
+input_latency_step_presented(unsigned long step);
+
+void
+input_latency_report();
+
+#endif
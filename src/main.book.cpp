@@ -126,6 +126,25 @@
 #include <functional>
 #include <cmath>
 #include "main.h"
+#include "options.h"
+#include "core_profile.h"
+#include "render_thread.h"
+#include "stream_buffer.h"
+#include "frame_pacing.h"
+#include "frame_capture.h"
+#include "input_latency.h"
+#include "vertex_capture.h"
+#include "mesh_scene.h"
+#include "mesh_model.h"
+#include "on_demand.h"
+#include "transform_cache.h"
+#include "collision.h"
+#include "picking.h"
+#include "clip_space.h"
+#include "culling.h"
+#include "timeline.h"
+#include "perf_counters.h"
+#include "startup.h"
 //----
 //
 //
@@ -151,24 +170,70 @@ static void error_callback(int error, const char* description)
     fprintf(stderr, "Error: %s\n", description);
 }
 //----
+
+//-Note when each key was pressed, to measure how long it takes to be displayed,
+//and whether a new frame is needed.
+
+//[source,C,linenums]
+//----
+static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+  input_latency_key_event(key, action);
+  on_demand_key_event(key, action);
+}
+//----
 //
 //
 //==== Define main
 //
+//[[startup]]
+//How long each step of starting up takes, and how long until the first frame
+//is shown, is measured by "startup_phase"; see "startup.h".  Any option may
+//also be given on the command line, e.g. "modelviewprojection 16 --fast-start",
+//instead of in the environment; see "options.h".
+//
 //-Set the error-handling callback
 //[source,C,linenums]
 //----
 int main(int argc, char *argv[])
 {
+  // before anything reads an option, as many keep the first value
+  // they read
+  if(!options_parse_arguments(argc, argv)){
+    return -1;
+  }
+  startup_phase("arguments");
   glfwSetErrorCallback(error_callback);
 
 //----
 //==== Let the User Pick the Chapter Number to Run.
 //[source,C,linenums]
 //----
-  std::cout << "Input Chapter Number to run: (2-17): " << std::endl;
-  int chapter_number;
-  std::cin >> chapter_number ;
+  // check every chapter against its golden image, each in a new process
+  if(regression_requested() && !regression_child()){
+    return regression_run_all(argv[0]);
+  }
+  // a split screen names its chapters itself
+  if(split_screen_requested() && !split_screen_init()){
+    return -1;
+  }
+  // from MVP_CHAPTER, or the command line, if given
+  int chapter_number = option_int("CHAPTER", 0);
+  if(split_screen_active()){
+    chapter_number = split_screen_highest_chapter();
+  }
+  else if(option_string("CHAPTER", NULL) == NULL){
+    if(startup_fast()){
+      fprintf(stderr, "Error: MVP_FAST_START requires a chapter, e.g. MVP_CHAPTER=16\n");
+      return -1;
+    }
+    startup_waiting_phase("chapter prompt");
+    std::cout << "Input Chapter Number to run: (2-17): " << std::endl;
+    std::cin >> chapter_number ;
+  }
+  // "render_scene" may draw one chapter as another, as chapter 15 does
+  // chapter 14, so the chapter asked for is kept
+  const int requested_chapter = chapter_number;
 //----
 //==== GLFW/OpenGL Initialization
 //
@@ -176,9 +241,11 @@ int main(int argc, char *argv[])
 //[source,C,linenums]
 //----
   //initialize video support, joystick support, etc.
+  startup_phase("glfwInit");
   if (!glfwInit()){
     return -1;
   }
+  timeline_name_thread("main");
 //----
 //
 //One frame is created incrementally over time on the CPU, but the frame
@@ -204,9 +271,30 @@ int main(int argc, char *argv[])
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 1);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
 //----
+//The "core profile" of OpenGL 3.3 removes "glBegin", "glVertex", and the matrix
+//stack, so only chapters 16 and 17 can be drawn with it.  See <<coreProfile>>.
+//[source,C,linenums]
+//----
+  const bool use_core_profile =
+    core_profile_requested() && chapter_number >= 16 && !split_screen_active();
+  if(core_profile_requested() && !use_core_profile){
+    fprintf(stderr, "Chapter %d requires OpenGL 1.4, ignoring MVP_CORE_PROFILE\n",
+            chapter_number);
+  }
+  if(use_core_profile){
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+  }
+//----
 //Create a 500 pixel by 500 pixel window, which the user can resize.
 //[source,C,linenums]
 //----
+  startup_phase("window");
+  if(regression_child()){
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  }
   /* Create a windowed mode window and its OpenGL context */
   if(!(window = glfwCreateWindow(500,
                                  500,
@@ -225,19 +313,68 @@ int main(int argc, char *argv[])
 //every version of OpenGL (of which there are many).
 //To make programming in OpenGL easier, all calls to OpenGL are actually calls to "GLEW" procedures,
 //which effectively are function pointers.  To ensure that those function pointers are initialized,
-//call "glewInit".
+//call "glewInit".  GLEW asks the current OpenGL context for the procedures,
+//so the window's context must be made current first.
 //See <<sharedLibAppendix>> for a more full explanantion.
 //[source,C,linenums]
 //----
-  glewInit(); // make OpenGL calls possible
+  glfwSetKeyCallback(window, key_callback);
+  on_demand_init(window);
+  startup_phase("context and loader");
   /* Make the window's context current */
   glfwMakeContextCurrent(window);
+  // core profiles do not list their procedures as extensions
+  glewExperimental = GL_TRUE;
+  glewInit(); // make OpenGL calls possible
+  startup_phase("renderers");
+  gl_trace_init();
+  if(use_core_profile && !core_profile_init()){
+    glfwTerminate();
+    return -1;
+  }
+  if(!use_core_profile && stream_buffer_requested() && !stream_buffer_init()){
+    glfwTerminate();
+    return -1;
+  }
+//----
+//How often frames are flushed to the monitor is described in <<framePacing>>.
+//Every frame can also be recorded to disk; see "frame_capture.h".
+//With MVP_FAST_START, the mesh is imported while the first frames are shown.
+//[source,C,linenums]
+//----
+  startup_phase("modules");
+  frame_pacing_init();
+  if(frame_capture_requested() && !frame_capture_init()){
+    glfwTerminate();
+    return -1;
+  }
+  if(vertex_capture_requested() && !vertex_capture_init()){
+    glfwTerminate();
+    return -1;
+  }
+  if(!use_core_profile && mesh_scene_requested() && !mesh_scene_init()){
+    glfwTerminate();
+    return -1;
+  }
+  if(!use_core_profile && mesh_model_requested()){
+    if(startup_fast()){
+      // the square is drawn until the mesh is ready
+      mesh_model_init_in_background();
+    }
+    else if(!mesh_model_init()){
+      glfwTerminate();
+      return -1;
+    }
+  }
+  picking_init(window);
+  perf_counters_init();
 //----
 //For every frame drawn, each pixel has a default color, set by
 //calling "glClearColor". "0,0,0,1", means black "0,0,0", without
 //transparency (the "1").
 //[source,C,linenums]
 //----
+  startup_phase("GL state");
   glClearColor(/*red*/   0.0,
                /*green*/ 0.0,
                /*blue*/  0.0,
@@ -253,6 +390,14 @@ int main(int argc, char *argv[])
 //----
   glDepthFunc(GL_GREATER);
 //----
+//The core-profile renderer uses the same depth convention as chapter 17.
+//[source,C,linenums]
+//----
+  if(use_core_profile){
+    glClearDepth(1.0f);
+    glDepthFunc(GL_LEQUAL);
+  }
+//----
 //Enable blending of new values in a fragment with the old value.
 //[source,C,linenums]
 //----
@@ -264,10 +409,12 @@ int main(int argc, char *argv[])
 //----
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-  glMatrixMode(GL_PROJECTION);
-  glLoadIdentity();
-  glMatrixMode(GL_MODELVIEW);
-  glLoadIdentity();
+  if(!use_core_profile){
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+  }
 //----
 //Map the normalized device-coordinates to screen coordinates, explained later.
 //[source,C,linenums]
@@ -280,6 +427,7 @@ int main(int argc, char *argv[])
                /*width_x*/ w,
                /*width_y*/ h);
   }
+  startup_initialized();
 //----
 //[[the-event-loop]]
 //==== The Event Loop
@@ -294,29 +442,123 @@ int main(int argc, char *argv[])
 //Render a frame for the user-selected demo, flush the complete frame to the monitor.
 //Unless the user closed the window, repeat indefinitely.
 //
+//[[framePacing]]
+//If nothing limited the loop, a fast computer would render frames far faster
+//than the monitor can display them, keeping one CPU core busy for no benefit.
+//By default, "glfwSwapBuffers" waits for the monitor's next refresh (*vsync*).
+//"frame_pacing_end_frame" can additionally cap the framerate, and it records how
+//evenly spaced the frames were.
+//
+//[[onDemand]]
+//Nothing in any chapter moves unless a key is held, so most frames are
+//identical to the one before.  If rendering on demand is enabled, the loop
+//instead sleeps until a key is pressed or the window is resized or uncovered.
+//
+//[[renderThread]]
+//With the core-profile renderer, the scene is a handful of numbers, so it can be
+//drawn by a thread of its own, while this thread reads the keyboard and moves the
+//objects at a steady rate, never waiting for the monitor; see "render_thread.h".
+//The render thread presents the frames, so the first loop below runs until the
+//window is closed, and the usual loop after it is then skipped.
+//
 //[source,C,linenums]
 //----
+  if(use_core_profile && render_thread_requested()){
+    if(!render_thread_start(window)){
+      mesh_model_wait();
+      glfwTerminate();
+      return -1;
+    }
+    while (!glfwWindowShouldClose(window))
+      {
+        input_latency_begin_frame();
+        render_scene(&chapter_number);
+        perf_counters_end_frame();
+        render_thread_wait_for_step();
+      }
+    render_thread_stop();
+  }
   while (!glfwWindowShouldClose(window))
     {
+      if(!on_demand_frame_needed()){
+        on_demand_wait();
+        continue;
+      }
+      // the phases of each frame are timed, if MVP_TRACE is set (see
+      // "timeline.h")
+      timeline_zone frame_zone("frame");
       // set viewport
       int width = 0, height = 0;
       glfwGetFramebufferSize(window, &width, &height);
       glViewport(0, 0,
                  width, height);
 
-      render_scene(&chapter_number);
+      stream_buffer_begin_frame();
+      input_latency_begin_frame();
+      regression_begin_frame();
+      if(split_screen_active()){
+        split_screen_render(render_scene);
+      }
+      else{
+        render_scene(&chapter_number);
+      }
+      quad_batch_end_frame();
+      culling_end_frame();
+      perf_counters_end_frame();
+      vertex_capture_end_frame();
+      stream_buffer_end_frame();
+      frame_capture_end_frame(width, height);
+      gl_trace_end_frame();
+      if(regression_end_frame(requested_chapter)){
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+      }
       // flush the frame
-      glfwSwapBuffers(window);
+      {
+        timeline_zone zone("swap");
+        glfwSwapBuffers(window);
+      }
+      startup_first_frame_presented();
+      input_latency_frame_presented();
+      on_demand_frame_presented();
 
       /* Poll for and process events */
-      glfwPollEvents();
+      {
+        timeline_zone zone("poll events");
+        glfwPollEvents();
+      }
+
+      frame_pacing_end_frame();
     }
 //----
 //==== The User Closed the App, Exit Cleanly.
 //[source,C,linenums]
 //----
+  // the frames still being recorded are counted once written, and the
+  // mesh, if still being imported, is waited for
+  frame_capture_shutdown();
+  mesh_model_wait();
+  frame_pacing_report();
+  frame_capture_report();
+  quad_batch_report();
+  gl_state_cache_report();
+  gl_trace_report();
+  input_latency_report();
+  on_demand_report();
+  transform_cache_report();
+  collision_report();
+  picking_report();
+  clip_space_report();
+  culling_report();
+  perf_counters_shutdown();
+  timeline_shutdown();
+  render_thread_report();
+  core_profile_shutdown();
+  stream_buffer_shutdown();
+  vertex_capture_shutdown();
+  mesh_scene_shutdown();
+  mesh_model_shutdown();
   glfwTerminate();
-  return 0;
+  return regression_exit_status();
 } // end main
 //----
 //=== Render the Selected Demo
@@ -329,9 +571,15 @@ int main(int argc, char *argv[])
 //[source,C,linenums]
 //----
 void render_scene(int *chapter_number){
-  // clear the framebuffer
-  glClear(GL_COLOR_BUFFER_BIT);
-  glClear(GL_DEPTH_BUFFER_BIT);
+  timeline_zone chapter_zone(timeline_chapter_name(*chapter_number));
+  // and what the processor did, if MVP_PERF_COUNTERS is set (see
+  // "perf_counters.h")
+  perf_counters_scope counting(*chapter_number);
+  // clear the framebuffer, both color and depth, in one call, unless
+  // another thread draws the frame (see "render_thread.h")
+  if(!render_thread_active()){
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  }
 //----
 //
 //When a graphics application is executing, it is creating new
@@ -621,13 +869,7 @@ void render_scene(int *chapter_number){
 //[source,C,linenums]
 //----
   std::function<void()> draw_in_square_viewport = [&](){
-    // clear all of the background to grey
-    glClearColor(/*red*/   0.2,
-                 /*green*/ 0.2,
-                 /*blue*/  0.2,
-                 /*alpha*/ 1.0);
-    glClear(GL_COLOR_BUFFER_BIT);
-
+    timeline_zone zone("draw_in_square_viewport");
     // resize drawing area
     int w, h;
     glfwGetFramebufferSize(window, &w, &h);
@@ -637,6 +879,19 @@ void render_scene(int *chapter_number){
                /*width_x*/ min,
                /*width_y*/ min);
 
+    // a square window is entirely covered by the square viewport,
+    // which was already cleared to black at the start of the frame
+    if(w == h){
+      return;
+    }
+
+    // clear all of the background to grey
+    glClearColor(/*red*/   0.2,
+                 /*green*/ 0.2,
+                 /*blue*/  0.2,
+                 /*alpha*/ 1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
     glEnable(GL_SCISSOR_TEST);
     glScissor(/*min_x*/ 0 + (w - min)/2,
               /*min_y*/ 0 + (h - min)/2,
@@ -1225,7 +1480,7 @@ void render_scene(int *chapter_number){
               /*blue*/  1.0);
     glBegin(GL_QUADS);
     {
-      for(Vertex modelspace : paddle){
+      auto to_ndc = [&](Vertex modelspace) -> transformed_vertex<Vertex>{
         Vertex worldSpace = modelspace
           .rotate(/*radians*/ paddle_1_rotation)
           .translate(/*x*/ -90.0,
@@ -1234,8 +1489,24 @@ void render_scene(int *chapter_number){
                                                   /*y*/ -camera_y);
         Vertex ndcSpace = cameraSpace.scale(/*x*/ 1.0/100.0,
                                             /*y*/ 1.0/100.0);
-        glVertex2f(/*x*/ ndcSpace.x,
-                   /*y*/ ndcSpace.y);
+        return {modelspace,
+                worldSpace,
+                cameraSpace,
+                ndcSpace};
+      };
+      // transformed again only when one of these has changed
+      static transform_cache<Vertex> cache;
+      for(const transformed_vertex<Vertex> &v :
+            transform_cached(cache,
+                             /*object*/ 1,
+                             {paddle_1_rotation,
+                              paddle_1_offset_Y,
+                              camera_x,
+                              camera_y},
+                             paddle,
+                             to_ndc)){
+        glVertex2f(/*x*/ v.ndcSpace.x,
+                   /*y*/ v.ndcSpace.y);
       }
     }
     glEnd();
@@ -1248,7 +1519,7 @@ void render_scene(int *chapter_number){
       glColor3f(/*red*/   1.0,
                 /*green*/ 1.0,
                 /*blue*/  0.0);
-      for(Vertex modelspace : paddle){
+      auto to_ndc = [&](Vertex modelspace) -> transformed_vertex<Vertex>{
         Vertex worldSpace = modelspace
           .rotate(/*radians*/ paddle_2_rotation)
           .translate(/*x*/ 90.0,
@@ -1257,8 +1528,24 @@ void render_scene(int *chapter_number){
                                                   /*y*/ -camera_y);
         Vertex ndcSpace = cameraSpace.scale(/*x*/ 1.0/100.0,
                                             /*y*/ 1.0/100.0);
-        glVertex2f(/*x*/ ndcSpace.x,
-                   /*y*/ ndcSpace.y);
+        return {modelspace,
+                worldSpace,
+                cameraSpace,
+                ndcSpace};
+      };
+      // transformed again only when one of these has changed
+      static transform_cache<Vertex> cache;
+      for(const transformed_vertex<Vertex> &v :
+            transform_cached(cache,
+                             /*object*/ 2,
+                             {paddle_2_rotation,
+                              paddle_2_offset_Y,
+                              camera_x,
+                              camera_y},
+                             paddle,
+                             to_ndc)){
+        glVertex2f(/*x*/ v.ndcSpace.x,
+                   /*y*/ v.ndcSpace.y);
       }
     }
     glEnd();
@@ -1300,7 +1587,7 @@ void render_scene(int *chapter_number){
               /*blue*/  1.0);
     glBegin(GL_QUADS);
     {
-      for(Vertex modelspace : paddle){
+      auto to_ndc = [&](Vertex modelspace) -> transformed_vertex<Vertex>{
         Vertex worldSpace = modelspace
           .rotate(/*radians*/ paddle_1_rotation)
           .translate(/*x*/ -90.0,
@@ -1309,8 +1596,24 @@ void render_scene(int *chapter_number){
                                                   /*y*/ -camera_y);
         Vertex ndcSpace = cameraSpace.scale(/*x*/ 1.0/100.0,
                                             /*y*/ 1.0/100.0);
-        glVertex2f(/*x*/ ndcSpace.x,
-                   /*y*/ ndcSpace.y);
+        return {modelspace,
+                worldSpace,
+                cameraSpace,
+                ndcSpace};
+      };
+      // transformed again only when one of these has changed
+      static transform_cache<Vertex> cache;
+      for(const transformed_vertex<Vertex> &v :
+            transform_cached(cache,
+                             /*object*/ 1,
+                             {paddle_1_rotation,
+                              paddle_1_offset_Y,
+                              camera_x,
+                              camera_y},
+                             paddle,
+                             to_ndc)){
+        glVertex2f(/*x*/ v.ndcSpace.x,
+                   /*y*/ v.ndcSpace.y);
       }
     }
     glEnd();
@@ -1321,7 +1624,7 @@ void render_scene(int *chapter_number){
       glColor3f(/*red*/   1.0,
                 /*green*/ 1.0,
                 /*blue*/  0.0);
-      for(Vertex modelspace : paddle){
+      auto to_ndc = [&](Vertex modelspace) -> transformed_vertex<Vertex>{
         Vertex worldSpace = modelspace
           .rotate(/*radians*/ paddle_2_rotation)
           .translate(/*x*/ 90.0,
@@ -1330,8 +1633,24 @@ void render_scene(int *chapter_number){
                                                   /*y*/ -camera_y);
         Vertex ndcSpace = cameraSpace.scale(/*x*/ 1.0/100.0,
                                             /*y*/ 1.0/100.0);
-        glVertex2f(/*x*/ ndcSpace.x,
-                   /*y*/ ndcSpace.y);
+        return {modelspace,
+                worldSpace,
+                cameraSpace,
+                ndcSpace};
+      };
+      // transformed again only when one of these has changed
+      static transform_cache<Vertex> cache;
+      for(const transformed_vertex<Vertex> &v :
+            transform_cached(cache,
+                             /*object*/ 2,
+                             {paddle_2_rotation,
+                              paddle_2_offset_Y,
+                              camera_x,
+                              camera_y},
+                             paddle,
+                             to_ndc)){
+        glVertex2f(/*x*/ v.ndcSpace.x,
+                   /*y*/ v.ndcSpace.y);
       }
     }
     glEnd();
@@ -1356,7 +1675,7 @@ void render_scene(int *chapter_number){
               /*blue*/  1.0);
     glBegin(GL_QUADS);
     {
-      for(Vertex modelspace : square){
+      auto to_ndc = [&](Vertex modelspace) -> transformed_vertex<Vertex>{
         Vertex worldSpace = modelspace
           .translate(/*x*/ 20.0f,
                      /*y*/ 0.0f)
@@ -1367,8 +1686,24 @@ void render_scene(int *chapter_number){
                                                   /*y*/ -camera_y);
         Vertex ndcSpace = cameraSpace.scale(/*x*/ 1.0/100.0,
                                             /*y*/ 1.0/100.0);
-        glVertex2f(/*x*/ ndcSpace.x,
-                   /*y*/ ndcSpace.y);
+        return {modelspace,
+                worldSpace,
+                cameraSpace,
+                ndcSpace};
+      };
+      // transformed again only when one of these has changed
+      static transform_cache<Vertex> cache;
+      for(const transformed_vertex<Vertex> &v :
+            transform_cached(cache,
+                             /*object*/ 3,
+                             {paddle_1_rotation,
+                              paddle_1_offset_Y,
+                              camera_x,
+                              camera_y},
+                             square,
+                             to_ndc)){
+        glVertex2f(/*x*/ v.ndcSpace.x,
+                   /*y*/ v.ndcSpace.y);
       }
     }
     glEnd();
@@ -1425,7 +1760,7 @@ void render_scene(int *chapter_number){
               /*blue*/  1.0);
     glBegin(GL_QUADS);
     {
-      for(Vertex modelspace : square){
+      auto to_ndc = [&](Vertex modelspace) -> transformed_vertex<Vertex>{
         Vertex worldSpace  = modelspace
           .rotate(/*radians*/ square_rotation)
           .translate(/*x*/ 20.0f,
@@ -1437,8 +1772,25 @@ void render_scene(int *chapter_number){
                                                   /*y*/ -camera_y);
         Vertex ndcSpace = cameraSpace.scale(/*x*/ 1.0/100.0,
                                             /*y*/ 1.0/100.0);
-        glVertex2f(/*x*/ ndcSpace.x,
-                   /*y*/ ndcSpace.y);
+        return {modelspace,
+                worldSpace,
+                cameraSpace,
+                ndcSpace};
+      };
+      // transformed again only when one of these has changed
+      static transform_cache<Vertex> cache;
+      for(const transformed_vertex<Vertex> &v :
+            transform_cached(cache,
+                             /*object*/ 3,
+                             {square_rotation,
+                              paddle_1_rotation,
+                              paddle_1_offset_Y,
+                              camera_x,
+                              camera_y},
+                             square,
+                             to_ndc)){
+        glVertex2f(/*x*/ v.ndcSpace.x,
+                   /*y*/ v.ndcSpace.y);
       }
       glEnd();
     }
@@ -1480,6 +1832,58 @@ void render_scene(int *chapter_number){
     rotation_around_paddle_1 += 0.1;
   }
 //----
+//[[collisions]]
+//=== Collisions
+//Nothing so far stops the paddles and the square from passing through each other.
+//If collision detection is enabled (see "collision.h"), the rectangle which each
+//object covers in world space is computed from the same offsets and rotations
+//which place it, and the objects are tested against each other.  If the keys held
+//during this frame moved two of them into each other, the move is undone: every
+//offset and rotation goes back to its value in the last frame without a collision.
+//The square is held by paddle 1, so those two are never tested against each other.
+//[source,C,linenums]
+//----
+  if(collision_enabled()){
+    static std::vector<collision_box> boxes;
+    static std::vector<collision_pair> pairs;
+    GLfloat *const state[] = {&paddle_1_offset_Y,
+                              &paddle_2_offset_Y,
+                              &paddle_1_rotation,
+                              &paddle_2_rotation,
+                              &square_rotation,
+                              &rotation_around_paddle_1};
+    static GLfloat last_apart[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+    const GLfloat around_paddle_1 = rotation_around_paddle_1 + paddle_1_rotation;
+    boxes.clear();
+    // x, y, half the width, half the height, rotation
+    boxes.push_back({-90.0f, paddle_1_offset_Y, 10.0f, 30.0f, paddle_1_rotation});
+    boxes.push_back({90.0f, paddle_2_offset_Y, 10.0f, 30.0f, paddle_2_rotation});
+    boxes.push_back({-90.0f + 20.0f * std::cos(around_paddle_1),
+                     paddle_1_offset_Y + 20.0f * std::sin(around_paddle_1),
+                     5.0f,
+                     5.0f,
+                     square_rotation + around_paddle_1});
+    collision_add_test_bodies(&boxes);
+    collision_find_pairs(boxes, &pairs);
+
+    bool collided = false;
+    for(const collision_pair &pair : pairs){
+      // between the paddles and the square, other than the square and its holder
+      if(pair.second < 3 && !(0 == pair.first && 2 == pair.second)){
+        collided = true;
+      }
+    }
+    for(int i = 0; i < 6; i++){
+      if(collided){
+        *state[i] = last_apart[i];
+      }
+      else{
+        last_apart[i] = *state[i];
+      }
+    }
+  }
+//----
 //[source,C,linenums]
 //----
   if(12 == *chapter_number){
@@ -1498,7 +1902,7 @@ void render_scene(int *chapter_number){
               /*blue*/  1.0);
     glBegin(GL_QUADS);
     {
-      for(Vertex modelspace : square){
+      auto to_ndc = [&](Vertex modelspace) -> transformed_vertex<Vertex>{
         Vertex worldSpace  = modelspace
           .rotate(/*radians*/ square_rotation)
           .translate(/*x*/ 20.0f,
@@ -1511,8 +1915,26 @@ void render_scene(int *chapter_number){
                                                   /*y*/ -camera_y);
         Vertex ndcSpace = cameraSpace.scale(/*x*/ 1.0/100.0,
                                             /*y*/ 1.0/100.0);
-        glVertex2f(/*x*/ ndcSpace.x,
-                   /*y*/ ndcSpace.y);
+        return {modelspace,
+                worldSpace,
+                cameraSpace,
+                ndcSpace};
+      };
+      // transformed again only when one of these has changed
+      static transform_cache<Vertex> cache;
+      for(const transformed_vertex<Vertex> &v :
+            transform_cached(cache,
+                             /*object*/ 3,
+                             {square_rotation,
+                              rotation_around_paddle_1,
+                              paddle_1_rotation,
+                              paddle_1_offset_Y,
+                              camera_x,
+                              camera_y},
+                             square,
+                             to_ndc)){
+        glVertex2f(/*x*/ v.ndcSpace.x,
+                   /*y*/ v.ndcSpace.y);
       }
       glEnd();
     }
@@ -1618,6 +2040,28 @@ void render_scene(int *chapter_number){
                              /*min_z*/ nearZ,
 			     /*max_z*/ farZ);
     };
+    // the same projection, stopping before the divide (see
+    // "clip_space.h"): "w" is the distance in front of the camera,
+    // by which "perspective" divides, without the "fabs".
+    clip_vertex clip(GLfloat nearZ,
+                     GLfloat farZ){
+      const GLfloat field_of_view =  DEG_TO_RAD(45.0/2.0);
+      int w, h;
+      glfwGetFramebufferSize(window, &w, &h);
+      GLfloat y_angle =  (w / h) * field_of_view;
+      const Vertex3 ndc_z = ortho(/*min_x*/ -1.0,
+                                  /*max_x*/ 1.0,
+                                  /*min_y*/ -1.0,
+                                  /*max_y*/ 1.0,
+                                  /*min_z*/ nearZ,
+                                  /*max_z*/ farZ);
+      clip_vertex result;
+      result.x = x / tan(field_of_view);
+      result.y = y / tan(y_angle);
+      result.z = ndc_z.z;
+      result.w = -z;
+      return result;
+    };
     GLfloat x;
     GLfloat y;
     GLfloat z;
@@ -1630,6 +2074,137 @@ void render_scene(int *chapter_number){
     draw_square3_programmable =
     [&](Vertex3_transformer f)
     {
+      // with MVP_CLIP_SPACE, "f" stops at the camera's space, and the
+      // perspective is applied here, after clipping
+      const GLfloat near_z = -0.1f, far_z = -1000.0f;
+      Vertex3_transformer to_ndc = f;
+      if(clip_space_enabled()){
+        to_ndc = [&](Vertex3 v){
+          return f(v).perspective(near_z, far_z);
+        };
+      }
+      if(culling_enabled()){
+        culling_begin_draw();
+      }
+      // an imported mesh, if there is one, takes the square's place
+      if(mesh_model_active()){
+        // the farther away, the fewer triangles
+        const Vertex3 ndc_center = to_ndc(Vertex3(/*x*/ 0.0, /*y*/ 0.0, /*z*/ 0.0));
+        GLfloat ndc_radius = 0.0;
+        for(int axis = 0; axis < 3; axis++){
+          const Vertex3 ndc_edge = to_ndc(Vertex3(/*x*/ axis == 0 ? 1.0 : 0.0,
+                                             /*y*/ axis == 1 ? 1.0 : 0.0,
+                                             /*z*/ axis == 2 ? 1.0 : 0.0));
+          const GLfloat length = hypot(ndc_edge.x - ndc_center.x,
+                                       ndc_edge.y - ndc_center.y);
+          if(length > ndc_radius){
+            ndc_radius = length;
+          }
+        }
+        const int level = mesh_model_level(ndc_radius);
+        if(clip_space_enabled()){
+          static std::vector<clip_vertex> corners;
+          corners.resize(mesh_model_number_of_corners(level));
+          for(uint64_t i = 0; i < corners.size(); i++){
+            GLfloat p[3];
+            mesh_model_corner(level, i, p);
+            corners[i] = f(Vertex3(/*x*/ p[0],
+                                   /*y*/ p[1],
+                                   /*z*/ p[2])).clip(near_z, far_z);
+          }
+          clip_space_draw_polygons(corners.data(),
+                                   corners.size() / 3,
+                                   /*corners_per_polygon*/ 3,
+                                   /*near_w*/ -near_z,
+                                   /*far_w*/ -far_z);
+          return;
+        }
+        // each triangle is taken to NDC before it is culled, or drawn
+        if(culling_enabled()){
+          glBegin(GL_TRIANGLES);
+          for(uint64_t i = 0; i + 2 < mesh_model_number_of_corners(level); i += 3){
+            GLfloat ndc[9];
+            for(int corner = 0; corner < 3; corner++){
+              GLfloat p[3];
+              mesh_model_corner(level, i + corner, p);
+              Vertex3 ndc_v = f(Vertex3(/*x*/ p[0],
+                                        /*y*/ p[1],
+                                        /*z*/ p[2]));
+              ndc[3*corner + 0] = ndc_v.x;
+              ndc[3*corner + 1] = ndc_v.y;
+              ndc[3*corner + 2] = ndc_v.z;
+            }
+            if(!culling_keep(ndc, 3)){
+              continue;
+            }
+            for(int corner = 0; corner < 3; corner++){
+              glVertex3f(/*x*/ ndc[3*corner + 0],
+                         /*y*/ ndc[3*corner + 1],
+                         /*z*/ ndc[3*corner + 2]);
+            }
+          }
+          glEnd();
+          return;
+        }
+        glBegin(GL_TRIANGLES);
+        for(uint64_t i = 0; i < mesh_model_number_of_corners(level); i++){
+          GLfloat p[3];
+          mesh_model_corner(level, i, p);
+          Vertex3 ndc_v = f(Vertex3(/*x*/ p[0],
+                                    /*y*/ p[1],
+                                    /*z*/ p[2]));
+          glVertex3f(/*x*/ ndc_v.x,
+                     /*y*/ ndc_v.y,
+                     /*z*/ ndc_v.z);
+        }
+        glEnd();
+        return;
+      }
+      if(clip_space_enabled()){
+        const clip_vertex corners[4] = {
+          f(Vertex3(/*x*/ -1.0, /*y*/ -1.0, /*z*/ 0.0)).clip(near_z, far_z),
+          f(Vertex3(/*x*/ 1.0,  /*y*/ -1.0, /*z*/ 0.0)).clip(near_z, far_z),
+          f(Vertex3(/*x*/ 1.0,  /*y*/ 1.0,  /*z*/ 0.0)).clip(near_z, far_z),
+          f(Vertex3(/*x*/ -1.0, /*y*/ 1.0,  /*z*/ 0.0)).clip(near_z, far_z)
+        };
+        clip_space_draw_polygons(corners,
+                                 /*number_of_polygons*/ 1,
+                                 /*corners_per_polygon*/ 4,
+                                 /*near_w*/ -near_z,
+                                 /*far_w*/ -far_z);
+        return;
+      }
+      // transform the square once, if it is to be culled, or written
+      // straight into the stream buffer
+      if(culling_enabled() || stream_buffer_active()){
+        const Vertex3 corners[4] = {
+          Vertex3(/*x*/ -1.0, /*y*/ -1.0, /*z*/ 0.0),
+          Vertex3(/*x*/ 1.0,  /*y*/ -1.0, /*z*/ 0.0),
+          Vertex3(/*x*/ 1.0,  /*y*/ 1.0,  /*z*/ 0.0),
+          Vertex3(/*x*/ -1.0, /*y*/ 1.0,  /*z*/ 0.0)
+        };
+        GLfloat ndc[12];
+        for(int i = 0; i < 4; i++){
+          Vertex3 ndc_v = f(corners[i]);
+          ndc[3*i + 0] = ndc_v.x;
+          ndc[3*i + 1] = ndc_v.y;
+          ndc[3*i + 2] = ndc_v.z;
+        }
+        if(culling_enabled() && !culling_keep(ndc, 4)){
+          return;
+        }
+        if(stream_buffer_active() && stream_buffer_draw_quad(ndc)){
+          return;
+        }
+        glBegin(GL_QUADS);
+        for(int i = 0; i < 4; i++){
+          glVertex3f(/*x*/ ndc[3*i + 0],
+                     /*y*/ ndc[3*i + 1],
+                     /*z*/ ndc[3*i + 2]);
+        }
+        glEnd();
+        return;
+      }
       glBegin(GL_QUADS);
       {
         Vertex3 ndc_v_1 = f(Vertex3(/*x*/ -1.0,
@@ -1710,7 +2285,7 @@ void render_scene(int *chapter_number){
               /*blue*/  1.0);
     glBegin(GL_QUADS);
     {
-      for(Vertex3 modelspace : square3D){
+      auto to_ndc = [&](Vertex3 modelspace) -> transformed_vertex<Vertex3>{
         Vertex3 worldSpace = modelspace
           .rotateZ(/*radians*/ square_rotation)
           .translate(/*x*/ 20.0f,
@@ -1733,9 +2308,27 @@ void render_scene(int *chapter_number){
                  /*max_y*/ 100.0f,
                  /*min_z*/ 100.0f,
                  /*max_z*/ -100.0f);
-        glVertex3f(/*x*/ ndcSpace.x,
-                   /*y*/ ndcSpace.y,
-                   /*z*/ ndcSpace.y);
+        return {modelspace,
+                worldSpace,
+                cameraSpace,
+                ndcSpace};
+      };
+      // transformed again only when one of these has changed
+      static transform_cache<Vertex3> cache;
+      for(const transformed_vertex<Vertex3> &v :
+            transform_cached(cache,
+                             /*object*/ 3,
+                             {square_rotation,
+                              rotation_around_paddle_1,
+                              paddle_1_rotation,
+                              paddle_1_offset_Y,
+                              camera_x,
+                              camera_y},
+                             square3D,
+                             to_ndc)){
+        glVertex3f(/*x*/ v.ndcSpace.x,
+                   /*y*/ v.ndcSpace.y,
+                   /*z*/ v.ndcSpace.y);
       }
       glEnd();
     }
@@ -1782,6 +2375,12 @@ void render_scene(int *chapter_number){
       moving_camera_z += move_multiple * cos(moving_camera_rot_y);
     }
   }
+  // each view of a split screen may move the camera further
+  split_screen_camera view(&moving_camera_x,
+                           &moving_camera_y,
+                           &moving_camera_z,
+                           &moving_camera_rot_y,
+                           &moving_camera_rot_x);
 //----
 //[source,C,linenums]
 //----
@@ -1796,7 +2395,7 @@ void render_scene(int *chapter_number){
               /*blue*/  1.0);
     glBegin(GL_QUADS);
     {
-      for(Vertex3 modelspace : paddle3D){
+      auto to_ndc = [&](Vertex3 modelspace) -> transformed_vertex<Vertex3>{
         Vertex3 worldSpace = modelspace
           .rotateZ(/*radians*/ paddle_1_rotation)
           .translate(/*x*/ -90.0,
@@ -1818,9 +2417,28 @@ void render_scene(int *chapter_number){
                  /*max_y*/ 100.0f,
                  /*min_z*/ 100.0f,
                  /*max_z*/ -100.0f);
-        glVertex3f(/*x*/ ndcSpace.x,
-                   /*y*/ ndcSpace.y,
-                   /*z*/ ndcSpace.z);
+        return {modelspace,
+                worldSpace,
+                cameraSpace,
+                ndcSpace};
+      };
+      // transformed again only when one of these has changed
+      static transform_cache<Vertex3> cache;
+      for(const transformed_vertex<Vertex3> &v :
+            transform_cached(cache,
+                             /*object*/ 1,
+                             {paddle_1_rotation,
+                              paddle_1_offset_Y,
+                              moving_camera_x,
+                              moving_camera_y,
+                              moving_camera_z,
+                              moving_camera_rot_y,
+                              moving_camera_rot_x},
+                             paddle3D,
+                             to_ndc)){
+        glVertex3f(/*x*/ v.ndcSpace.x,
+                   /*y*/ v.ndcSpace.y,
+                   /*z*/ v.ndcSpace.z);
       }
     }
     glEnd();
@@ -1833,7 +2451,7 @@ void render_scene(int *chapter_number){
               /*blue*/  1.0);
     glBegin(GL_QUADS);
     {
-      for(Vertex3 modelspace : square3D){
+      auto to_ndc = [&](Vertex3 modelspace) -> transformed_vertex<Vertex3>{
         Vertex3 worldSpace = modelspace
           .rotateZ(/*radians*/ square_rotation)
           .translate(/*x*/ 20.0f,
@@ -1859,9 +2477,30 @@ void render_scene(int *chapter_number){
                  /*max_y*/ 100.0f,
                  /*min_z*/ 100.0f,
                  /*max_z*/ -100.0f);
-        glVertex3f(/*x*/ ndcSpace.x,
-                   /*y*/ ndcSpace.y,
-                   /*z*/ ndcSpace.z);
+        return {modelspace,
+                worldSpace,
+                cameraSpace,
+                ndcSpace};
+      };
+      // transformed again only when one of these has changed
+      static transform_cache<Vertex3> cache;
+      for(const transformed_vertex<Vertex3> &v :
+            transform_cached(cache,
+                             /*object*/ 3,
+                             {square_rotation,
+                              rotation_around_paddle_1,
+                              paddle_1_rotation,
+                              paddle_1_offset_Y,
+                              moving_camera_x,
+                              moving_camera_y,
+                              moving_camera_z,
+                              moving_camera_rot_y,
+                              moving_camera_rot_x},
+                             square3D,
+                             to_ndc)){
+        glVertex3f(/*x*/ v.ndcSpace.x,
+                   /*y*/ v.ndcSpace.y,
+                   /*z*/ v.ndcSpace.z);
       }
       glEnd();
     }
@@ -1874,7 +2513,7 @@ void render_scene(int *chapter_number){
       glColor3f(/*red*/   1.0,
                 /*green*/ 1.0,
                 /*blue*/  0.0);
-      for(Vertex3 modelspace : paddle3D){
+      auto to_ndc = [&](Vertex3 modelspace) -> transformed_vertex<Vertex3>{
         Vertex3 worldSpace = modelspace
           .rotateZ(/*radians*/ paddle_2_rotation)
           .translate(/*x*/ 90.0,
@@ -1895,9 +2534,28 @@ void render_scene(int *chapter_number){
                  /*max_y*/ 100.0f,
                  /*min_z*/ 100.0f,
                  /*max_z*/ -100.0f);
-        glVertex3f(/*x*/ ndcSpace.x,
-                   /*y*/ ndcSpace.y,
-                   /*z*/ ndcSpace.z);
+        return {modelspace,
+                worldSpace,
+                cameraSpace,
+                ndcSpace};
+      };
+      // transformed again only when one of these has changed
+      static transform_cache<Vertex3> cache;
+      for(const transformed_vertex<Vertex3> &v :
+            transform_cached(cache,
+                             /*object*/ 2,
+                             {paddle_2_rotation,
+                              paddle_2_offset_Y,
+                              moving_camera_x,
+                              moving_camera_y,
+                              moving_camera_z,
+                              moving_camera_rot_y,
+                              moving_camera_rot_x},
+                             paddle3D,
+                             to_ndc)){
+        glVertex3f(/*x*/ v.ndcSpace.x,
+                   /*y*/ v.ndcSpace.y,
+                   /*z*/ v.ndcSpace.z);
       }
     }
     glEnd();
@@ -1915,7 +2573,7 @@ void render_scene(int *chapter_number){
 //== Considering Depth
 //[source,C,linenums]
 //----
-  if(*chapter_number >= 15){
+  if(*chapter_number >= 15 && !render_thread_active()){
     glEnable(GL_DEPTH_TEST);
   }
 ////TODO - write something about how "now that depth testing is enabled for all subequent demos, rerun the previous demo to show that the square becomes hidden as the user navigates
@@ -1969,11 +2627,64 @@ void render_scene(int *chapter_number){
 //----
 
 
+//[[coreProfile]]
+//Chapters 16 and 17 place the paddles, the square and the camera the
+//same way, so their positions are gathered into a "scene".
+//[source,C,linenums]
+//----
+  core_profile_scene scene;
+  if(*chapter_number >= 16){
+    scene.paddle_1_offset_Y = paddle_1_offset_Y;
+    scene.paddle_2_offset_Y = paddle_2_offset_Y;
+    scene.paddle_1_rotation = paddle_1_rotation;
+    scene.paddle_2_rotation = paddle_2_rotation;
+    scene.square_rotation = square_rotation;
+    scene.rotation_around_paddle_1 = rotation_around_paddle_1;
+    scene.moving_camera_x = moving_camera_x;
+    scene.moving_camera_y = moving_camera_y;
+    scene.moving_camera_z = moving_camera_z;
+    scene.moving_camera_rot_x = moving_camera_rot_x;
+    scene.moving_camera_rot_y = moving_camera_rot_y;
+    glfwGetFramebufferSize(window,
+                           &scene.framebuffer_width,
+                           &scene.framebuffer_height);
+//----
+//[[picking]]
+//A click, or the cursor's movement, arrives between frames, so the
+//objects under the mouse are found against the scene last drawn
+//(see "picking.h").  The ray through the cursor is the inverse of the
+//projection and camera: it begins at the near plane and ends at the
+//far plane.  Only chapter 17 draws the objects of MVP_SCENE.
+//[source,C,linenums]
+//----
+    picking_set_scene(scene, 17 == *chapter_number);
+  }
+//----
+//If the core-profile renderer is active, chapters 16 and 17 are drawn
+//by the graphics card instead.  The same transformations
+//are composed into model and camera matrices, which a vertex shader
+//applies to every vertex.
+//[source,C,linenums]
+//----
+  if(core_profile_active()){
+    if(render_thread_active()){
+      render_thread_publish(scene);
+    }
+    else{
+      core_profile_render(scene);
+    }
+    return;
+  }
+//----
 //[source,C,linenums]
 //----
   if(16 == *chapter_number){
-    // every shape is projected the same way
+    // every shape is projected the same way, unless it is clipped
+    // first, in which case "draw_square3_programmable" projects it
     transformationStack.push_back([&](Vertex3 v){
+        if(clip_space_enabled()){
+          return v;
+        }
         return v.perspective(-0.1f,
                              -1000.0f);
       });
@@ -2097,6 +2808,10 @@ void render_scene(int *chapter_number){
 //[source,C,linenums]
 //----
   std::function<void()> draw_square_opengl2point1 = [&](){
+    if(mesh_model_active()){
+      mesh_model_draw();
+      return;
+    }
     glBegin(GL_QUADS);
     {
       glVertex2f(/*x*/ -1.0,
@@ -2216,6 +2931,8 @@ void render_scene(int *chapter_number){
              /*z*/ 1.0f);
     draw_square_opengl2point1();
     glPopMatrix();
+    // objects loaded from MVP_SCENE, if any, placed in world space
+    mesh_scene_draw();
     return;
   }
   // in later demos,
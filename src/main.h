@@ -24,6 +24,11 @@
 #include <GLFW/glfw3.h>
 #include <assert.h>
 #include <GL/glu.h>
+#include "quad_batch.h"
+#include "split_screen.h"
+#include "gl_state_cache.h"
+#include "gl_trace.h"
+#include "regression.h"
 
 
 extern GLFWwindow* window;
@@ -0,0 +1,157 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <cmath>
+#include "matrix.h"
+
+Matrix4
+Matrix4::identity()
+{
+  Matrix4 result;
+  for(int i = 0; i < 16; i++){
+    result.m[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+  }
+  return result;
+}
+
+Matrix4
+Matrix4::perspective(float field_of_view_y_in_degrees,
+                     float aspect_ratio,
+                     float nearZ,
+                     float farZ)
+{
+  const float f = 1.0f / tan(field_of_view_y_in_degrees / 2.0f
+                             * 3.14159265f / 180.0f);
+  Matrix4 result = identity();
+  result.m[0]  = f / aspect_ratio;
+  result.m[5]  = f;
+  result.m[10] = (farZ + nearZ) / (nearZ - farZ);
+  result.m[11] = -1.0f;
+  result.m[14] = (2.0f * farZ * nearZ) / (nearZ - farZ);
+  result.m[15] = 0.0f;
+  return result;
+}
+
+Matrix4
+Matrix4::multiply(const Matrix4 &rhs) const
+{
+  Matrix4 result;
+  for(int column = 0; column < 4; column++){
+    for(int row = 0; row < 4; row++){
+      float sum = 0.0f;
+      for(int k = 0; k < 4; k++){
+        sum += at(row, k) * rhs.at(k, column);
+      }
+      result.m[column*4 + row] = sum;
+    }
+  }
+  return result;
+}
+
+Matrix4
+Matrix4::translate(float translate_x,
+                   float translate_y,
+                   float translate_z) const
+{
+  Matrix4 t = identity();
+  t.m[12] = translate_x;
+  t.m[13] = translate_y;
+  t.m[14] = translate_z;
+  return multiply(t);
+}
+
+Matrix4
+Matrix4::rotateX(float angle_in_radians) const
+{
+  Matrix4 r = identity();
+  r.m[5]  = cos(angle_in_radians);
+  r.m[6]  = sin(angle_in_radians);
+  r.m[9]  = -sin(angle_in_radians);
+  r.m[10] = cos(angle_in_radians);
+  return multiply(r);
+}
+
+Matrix4
+Matrix4::rotateY(float angle_in_radians) const
+{
+  Matrix4 r = identity();
+  r.m[0]  = cos(angle_in_radians);
+  r.m[2]  = -sin(angle_in_radians);
+  r.m[8]  = sin(angle_in_radians);
+  r.m[10] = cos(angle_in_radians);
+  return multiply(r);
+}
+
+Matrix4
+Matrix4::rotateZ(float angle_in_radians) const
+{
+  Matrix4 r = identity();
+  r.m[0] = cos(angle_in_radians);
+  r.m[1] = sin(angle_in_radians);
+  r.m[4] = -sin(angle_in_radians);
+  r.m[5] = cos(angle_in_radians);
+  return multiply(r);
+}
+
+Matrix4
+Matrix4::scale(float scale_x,
+               float scale_y,
+               float scale_z) const
+{
+  Matrix4 s = identity();
+  s.m[0]  = scale_x;
+  s.m[5]  = scale_y;
+  s.m[10] = scale_z;
+  return multiply(s);
+}
+
+Matrix4
+Matrix4::inverse() const
+{
+  // the adjugate, by cofactors of 2x2 sub-determinants, over the
+  // determinant
+  const float *a = m;
+  const float s0 = a[0] * a[5] - a[4] * a[1];
+  const float s1 = a[0] * a[6] - a[4] * a[2];
+  const float s2 = a[0] * a[7] - a[4] * a[3];
+  const float s3 = a[1] * a[6] - a[5] * a[2];
+  const float s4 = a[1] * a[7] - a[5] * a[3];
+  const float s5 = a[2] * a[7] - a[6] * a[3];
+  const float c5 = a[10] * a[15] - a[14] * a[11];
+  const float c4 = a[9] * a[15] - a[13] * a[11];
+  const float c3 = a[9] * a[14] - a[13] * a[10];
+  const float c2 = a[8] * a[15] - a[12] * a[11];
+  const float c1 = a[8] * a[14] - a[12] * a[10];
+  const float c0 = a[8] * a[13] - a[12] * a[9];
+  const float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  Matrix4 result;
+  if(determinant == 0.0f){
+    for(int i = 0; i < 16; i++){
+      result.m[i] = 0.0f;
+    }
+    return result;
+  }
+  const float d = 1.0f / determinant;
+  float *r = result.m;
+  r[0]  = ( a[5] * c5 - a[6] * c4 + a[7] * c3) * d;
+  r[1]  = (-a[1] * c5 + a[2] * c4 - a[3] * c3) * d;
+  r[2]  = ( a[13] * s5 - a[14] * s4 + a[15] * s3) * d;
+  r[3]  = (-a[9] * s5 + a[10] * s4 - a[11] * s3) * d;
+  r[4]  = (-a[4] * c5 + a[6] * c2 - a[7] * c1) * d;
+  r[5]  = ( a[0] * c5 - a[2] * c2 + a[3] * c1) * d;
+  r[6]  = (-a[12] * s5 + a[14] * s2 - a[15] * s1) * d;
+  r[7]  = ( a[8] * s5 - a[10] * s2 + a[11] * s1) * d;
+  r[8]  = ( a[4] * c4 - a[5] * c2 + a[7] * c0) * d;
+  r[9]  = (-a[0] * c4 + a[1] * c2 - a[3] * c0) * d;
+  r[10] = ( a[12] * s4 - a[13] * s2 + a[15] * s0) * d;
+  r[11] = (-a[8] * s4 + a[9] * s2 - a[11] * s0) * d;
+  r[12] = (-a[4] * c3 + a[5] * c1 - a[6] * c0) * d;
+  r[13] = ( a[0] * c3 - a[1] * c1 + a[2] * c0) * d;
+  r[14] = (-a[12] * s3 + a[13] * s1 - a[14] * s0) * d;
+  r[15] = ( a[8] * s3 - a[9] * s1 + a[10] * s0) * d;
+  return result;
+}
@@ -0,0 +1,48 @@
+#ifndef MATRIX_H
+#define MATRIX_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* A 4x4 matrix, stored in column-major order so that "m" can be
+ * handed to OpenGL directly.
+ *
+ * "translate", "rotateX", "rotateY", "rotateZ" and "scale"
+ * post-multiply, exactly like "glTranslatef", "glRotatef" and
+ * "glScalef" do to the current OpenGL matrix.  Chapter 17's
+ * sequence of matrix calls therefore reads the same when written
+ * with Matrix4.
+ */
+class Matrix4 {
+public:
+  float m[16];
+
+  static Matrix4 identity();
+  // same as gluPerspective
+  static Matrix4 perspective(float field_of_view_y_in_degrees,
+                             float aspect_ratio,
+                             float nearZ,
+                             float farZ);
+
+  Matrix4 multiply(const Matrix4 &rhs) const;
+  Matrix4 translate(float translate_x,
+                    float translate_y,
+                    float translate_z) const;
+  Matrix4 rotateX(float angle_in_radians) const;
+  Matrix4 rotateY(float angle_in_radians) const;
+  Matrix4 rotateZ(float angle_in_radians) const;
+  Matrix4 scale(float scale_x,
+                float scale_y,
+                float scale_z) const;
+  // the identity, divided by this; all zeros if there is none
+  Matrix4 inverse() const;
+
+  // the element at "row", "column"
+  float at(int row, int column) const { return m[column*4 + row]; }
+};
+
+#endif
@@ -0,0 +1,245 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#ifndef _WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "main.h"
+#include "mesh_file.h"
+
+static_assert(sizeof(mesh_file_header) == 64, "mesh_file_header is padded");
+static_assert(sizeof(mesh_file_mesh) == 32, "mesh_file_mesh is padded");
+static_assert(sizeof(mesh_file_object) == 80, "mesh_file_object is padded");
+
+static const uint64_t alignment = 16;
+
+static uint64_t
+aligned(uint64_t bytes)
+{
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+// true if "count" items of "item_bytes" each, at "offset", lie within the file
+static bool
+within(const mesh_file &file,
+       uint64_t offset,
+       uint64_t count,
+       uint64_t item_bytes)
+{
+  return offset % alignment == 0
+    && offset <= file.size
+    && count <= (file.size - offset) / item_bytes;
+}
+
+static bool
+map_file(const char *path,
+         mesh_file *file)
+{
+#ifdef _WINDOWS
+  HANDLE handle = CreateFileA(path,
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              NULL,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+                              NULL);
+  if(handle == INVALID_HANDLE_VALUE){
+    return false;
+  }
+  LARGE_INTEGER size;
+  if(!GetFileSizeEx(handle, &size) || size.QuadPart == 0){
+    CloseHandle(handle);
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if(mapping == NULL){
+    CloseHandle(handle);
+    return false;
+  }
+  const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if(data == NULL){
+    CloseHandle(mapping);
+    CloseHandle(handle);
+    return false;
+  }
+  file->data = (const char *) data;
+  file->size = (uint64_t) size.QuadPart;
+  file->file_handle = handle;
+  file->mapping_handle = mapping;
+#else
+  const int descriptor = open(path, O_RDONLY);
+  if(descriptor < 0){
+    return false;
+  }
+  struct stat status;
+  if(fstat(descriptor, &status) != 0 || status.st_size == 0){
+    close(descriptor);
+    return false;
+  }
+  void *data = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  // the mapping keeps the file open
+  close(descriptor);
+  if(data == MAP_FAILED){
+    return false;
+  }
+  file->data = (const char *) data;
+  file->size = (uint64_t) status.st_size;
+  file->file_handle = NULL;
+  file->mapping_handle = NULL;
+#endif
+  return true;
+}
+
+bool
+mesh_file_open(const char *path,
+               mesh_file *file)
+{
+  memset(file, 0, sizeof(*file));
+  if(!map_file(path, file)){
+    fprintf(stderr, "Error: could not map %s\n", path);
+    return false;
+  }
+  const mesh_file_header *header = (const mesh_file_header *) file->data;
+  bool valid = file->size >= sizeof(mesh_file_header)
+    && memcmp(header->magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC)) == 0
+    && header->version == MESH_FILE_VERSION
+    && header->header_bytes == sizeof(mesh_file_header)
+    && header->file_bytes == file->size
+    && within(*file, header->meshes_offset, header->number_of_meshes,
+              sizeof(mesh_file_mesh))
+    && within(*file, header->objects_offset, header->number_of_objects,
+              sizeof(mesh_file_object));
+  if(valid){
+    file->header = header;
+    file->meshes = (const mesh_file_mesh *) (file->data + header->meshes_offset);
+    file->objects = (const mesh_file_object *) (file->data + header->objects_offset);
+  }
+  for(uint64_t i = 0; valid && i < header->number_of_meshes; i++){
+    const mesh_file_mesh &mesh = file->meshes[i];
+    valid = within(*file, mesh.vertices_offset, mesh.number_of_vertices,
+                   3 * sizeof(float))
+      && within(*file, mesh.indices_offset, mesh.number_of_indices,
+                sizeof(uint32_t))
+      && mesh.number_of_indices % 3 == 0
+      // drawn in one call
+      && mesh.number_of_indices <= (uint64_t) INT_MAX;
+  }
+  for(uint64_t i = 0; valid && i < header->number_of_objects; i++){
+    valid = file->objects[i].mesh < header->number_of_meshes;
+  }
+  if(!valid){
+    fprintf(stderr, "Error: %s is not a version %d mesh file\n",
+            path, MESH_FILE_VERSION);
+    mesh_file_close(file);
+    return false;
+  }
+  return true;
+}
+
+void
+mesh_file_close(mesh_file *file)
+{
+  if(file->data == NULL){
+    return;
+  }
+#ifdef _WINDOWS
+  UnmapViewOfFile(file->data);
+  CloseHandle((HANDLE) file->mapping_handle);
+  CloseHandle((HANDLE) file->file_handle);
+#else
+  munmap((void *) file->data, (size_t) file->size);
+#endif
+  memset(file, 0, sizeof(*file));
+}
+
+bool
+mesh_file_indices_valid(const mesh_file &file,
+                        const mesh_file_mesh &mesh)
+{
+  const uint32_t *indices = mesh_file_indices(file, mesh);
+  for(uint64_t i = 0; i < mesh.number_of_indices; i++){
+    if(indices[i] >= mesh.number_of_vertices){
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool
+write_padded(FILE *out,
+             const void *data,
+             uint64_t bytes)
+{
+  static const char zeros[alignment] = {0};
+  if(bytes > 0 && fwrite(data, 1, (size_t) bytes, out) != bytes){
+    return false;
+  }
+  const uint64_t padding = aligned(bytes) - bytes;
+  return padding == 0 || fwrite(zeros, 1, (size_t) padding, out) == padding;
+}
+
+bool
+mesh_file_write(const char *path,
+                const std::vector<mesh_data> &meshes,
+                const std::vector<mesh_file_object> &objects)
+{
+  // lay out the file before writing any of it
+  mesh_file_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC));
+  header.version = MESH_FILE_VERSION;
+  header.header_bytes = sizeof(mesh_file_header);
+  header.number_of_meshes = meshes.size();
+  header.meshes_offset = sizeof(mesh_file_header);
+  header.number_of_objects = objects.size();
+  header.objects_offset = header.meshes_offset
+    + meshes.size() * sizeof(mesh_file_mesh);
+  uint64_t offset = header.objects_offset
+    + objects.size() * sizeof(mesh_file_object);
+  std::vector<mesh_file_mesh> table(meshes.size());
+  for(size_t i = 0; i < meshes.size(); i++){
+    table[i].number_of_vertices = meshes[i].vertices.size() / 3;
+    table[i].vertices_offset = offset;
+    offset += aligned(meshes[i].vertices.size() * sizeof(float));
+    table[i].number_of_indices = meshes[i].indices.size();
+    table[i].indices_offset = offset;
+    offset += aligned(meshes[i].indices.size() * sizeof(uint32_t));
+  }
+  header.file_bytes = offset;
+
+  FILE *out = fopen(path, "wb");
+  if(out == NULL){
+    fprintf(stderr, "Error: could not write %s\n", path);
+    return false;
+  }
+  bool ok = write_padded(out, &header, sizeof(header))
+    && (table.empty()
+        || write_padded(out, &table[0], table.size() * sizeof(mesh_file_mesh)))
+    && (objects.empty()
+        || write_padded(out, &objects[0], objects.size() * sizeof(mesh_file_object)));
+  for(size_t i = 0; ok && i < meshes.size(); i++){
+    const mesh_data &mesh = meshes[i];
+    ok = write_padded(out,
+                      mesh.vertices.empty() ? NULL : &mesh.vertices[0],
+                      mesh.vertices.size() * sizeof(float))
+      && write_padded(out,
+                      mesh.indices.empty() ? NULL : &mesh.indices[0],
+                      mesh.indices.size() * sizeof(uint32_t));
+  }
+  ok = fclose(out) == 0 && ok;
+  if(!ok){
+    fprintf(stderr, "Error: could not write %s\n", path);
+    remove(path);
+  }
+  return ok;
+}
@@ -0,0 +1,115 @@
+#ifndef MESH_FILE_H
+#define MESH_FILE_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+#include <vector>
+
+/* A binary file of meshes, and of the objects which place them in a
+ * scene.
+ *
+ * The file is mapped into memory and used where it lies; nothing in it
+ * is parsed or copied.  Every structure is a multiple of 16 bytes long,
+ * and begins at an offset which is a multiple of 16, so that each may
+ * be read directly from the mapping.  Offsets and counts are 64 bits,
+ * so files may be larger than 4 GiB.  All values are little-endian.
+ *
+ *   mesh_file_header
+ *   number_of_meshes  * mesh_file_mesh
+ *   number_of_objects * mesh_file_object
+ *   for each mesh, its vertices (float x, y, z) and its indices
+ *   (uint32, three per triangle), each padded to 16 bytes
+ */
+
+#define MESH_FILE_MAGIC "MVPMESH"
+#define MESH_FILE_VERSION 1
+
+struct mesh_file_header {
+  char magic[8];               // "MVPMESH", and a terminating zero
+  uint32_t version;
+  uint32_t header_bytes;       // sizeof(mesh_file_header)
+  uint64_t file_bytes;
+  uint64_t number_of_meshes;
+  uint64_t meshes_offset;
+  uint64_t number_of_objects;
+  uint64_t objects_offset;
+  uint64_t zero;
+};
+
+struct mesh_file_mesh {
+  uint64_t number_of_vertices;
+  uint64_t vertices_offset;
+  uint64_t number_of_indices;
+  uint64_t indices_offset;
+};
+
+struct mesh_file_object {
+  float transform[16];         // column-major, as "Matrix4"
+  float color[3];
+  uint32_t mesh;
+};
+
+/* an open, mapped file */
+struct mesh_file {
+  const mesh_file_header *header;
+  const mesh_file_mesh *meshes;
+  const mesh_file_object *objects;
+  // the mapping
+  const char *data;
+  uint64_t size;
+  void *file_handle;
+  void *mapping_handle;
+};
+
+/* one mesh, before it is written */
+struct mesh_data {
+  std::vector<float> vertices;
+  std::vector<uint32_t> indices;
+};
+
+/* map "path", and check that every offset in it lies within the file.
+ * Returns false, after printing the reason to stderr, if it does not.
+ */
+bool
+mesh_file_open(const char *path,
+               mesh_file *file);
+
+void
+mesh_file_close(mesh_file *file);
+
+inline const float *
+mesh_file_vertices(const mesh_file &file,
+                   const mesh_file_mesh &mesh)
+{
+  return (const float *) (file.data + mesh.vertices_offset);
+}
+
+inline const uint32_t *
+mesh_file_indices(const mesh_file &file,
+                  const mesh_file_mesh &mesh)
+{
+  return (const uint32_t *) (file.data + mesh.indices_offset);
+}
+
+/* true if every index of "mesh" names one of its vertices.  This reads
+ * all of the indices, so "mesh_file_open" leaves it to those who use
+ * them, once per mesh.
+ */
+bool
+mesh_file_indices_valid(const mesh_file &file,
+                        const mesh_file_mesh &mesh);
+
+/* Returns false, after printing the reason to stderr, if the file
+ * cannot be written.
+ */
+bool
+mesh_file_write(const char *path,
+                const std::vector<mesh_data> &meshes,
+                const std::vector<mesh_file_object> &objects);
+
+#endif
@@ -0,0 +1,861 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "main.h"
+#include "options.h"
+#include "mesh_file.h"
+#include "mesh_import.h"
+#include "mesh_optimize.h"
+#include "mesh_simplify.h"
+
+// change whenever the importer's output changes, so that files
+// converted by an older importer are not used
+static const uint64_t importer_version = 3;
+
+typedef std::chrono::steady_clock import_clock;
+
+static int
+number_of_threads()
+{
+  int threads = option_int("IMPORT_THREADS", 0);
+  if(threads <= 0){
+    threads = (int) std::thread::hardware_concurrency();
+  }
+  return threads < 1 ? 1 : threads;
+}
+
+// call "work(i)" for each "i" in [0, n), each on its own thread
+template<typename F>
+static void
+parallel_for(int n,
+             F work)
+{
+  std::vector<std::thread> threads;
+  for(int i = 1; i < n; i++){
+    threads.push_back(std::thread(work, i));
+  }
+  work(0);
+  for(size_t i = 0; i < threads.size(); i++){
+    threads[i].join();
+  }
+}
+
+// the whole file, followed by a zero, so that "strtof" always stops
+static bool
+read_file(const char *path,
+          std::vector<char> *contents)
+{
+  FILE *file = fopen(path, "rb");
+  if(file == NULL){
+    return false;
+  }
+  const size_t block = 1 << 20;
+  size_t size = 0;
+  for(;;){
+    contents->resize(size + block);
+    const size_t n = fread(&(*contents)[size], 1, block, file);
+    size += n;
+    if(n < block){
+      break;
+    }
+  }
+  const bool ok = !ferror(file);
+  fclose(file);
+  contents->resize(size + 1);
+  (*contents)[size] = '\0';
+  return ok;
+}
+
+// "chunks" + 1 offsets into "data", each the start of a line
+static std::vector<size_t>
+split_into_lines(const char *data,
+                 size_t size,
+                 int chunks)
+{
+  std::vector<size_t> boundaries(1, 0);
+  for(int i = 1; i < chunks; i++){
+    size_t offset = std::max(boundaries.back(), size * i / chunks);
+    const void *newline = offset < size
+      ? memchr(data + offset, '\n', size - offset)
+      : NULL;
+    offset = newline == NULL ? size : (const char *) newline - data + 1;
+    boundaries.push_back(offset);
+  }
+  boundaries.push_back(size);
+  return boundaries;
+}
+
+static const char *
+end_of_line(const char *p,
+            const char *end)
+{
+  const void *newline = memchr(p, '\n', end - p);
+  return newline == NULL ? end : (const char *) newline;
+}
+
+static const char *
+skip_blanks(const char *p,
+            const char *end)
+{
+  while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')){
+    p++;
+  }
+  return p;
+}
+
+static bool
+parse_float(const char **p,
+            const char *end,
+            float *value)
+{
+  const char *start = skip_blanks(*p, end);
+  if(start >= end){
+    return false;
+  }
+  char *after;
+  *value = strtof(start, &after);
+  if(after == start || after > end){
+    return false;
+  }
+  *p = after;
+  return true;
+}
+
+static bool
+parse_integer(const char **p,
+              const char *end,
+              long long *value)
+{
+  const char *start = skip_blanks(*p, end);
+  if(start >= end){
+    return false;
+  }
+  char *after;
+  *value = strtoll(start, &after, 10);
+  if(after == start || after > end){
+    return false;
+  }
+  *p = after;
+  return true;
+}
+
+// add the triangles of a convex polygon to "corners", as a fan
+template<typename T>
+static void
+triangulate(const std::vector<T> &polygon,
+            std::vector<T> *corners)
+{
+  for(size_t i = 1; i + 1 < polygon.size(); i++){
+    corners->push_back(polygon[0]);
+    corners->push_back(polygon[i]);
+    corners->push_back(polygon[i + 1]);
+  }
+}
+
+/*
+ * Wavefront OBJ.  Only "v" and "f" lines are read.
+ */
+
+// an index from an "f" line.  Negative indices count back from the
+// last vertex so far; they cannot be resolved until the number of
+// vertices in the chunks before this one is known
+struct obj_index {
+  long long value;
+  bool relative;
+};
+
+struct obj_chunk {
+  std::vector<float> positions;
+  std::vector<obj_index> corners;
+  bool ok;
+};
+
+static void
+parse_obj_chunk(const char *p,
+                const char *end,
+                obj_chunk *chunk)
+{
+  chunk->ok = true;
+  std::vector<obj_index> polygon;
+  while(p < end){
+    const char *line_end = end_of_line(p, end);
+    p = skip_blanks(p, line_end);
+    if(line_end - p > 1 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')){
+      p++;
+      float position[3];
+      for(int i = 0; i < 3; i++){
+        if(!parse_float(&p, line_end, &position[i])){
+          chunk->ok = false;
+          return;
+        }
+        chunk->positions.push_back(position[i]);
+      }
+    }
+    else if(line_end - p > 1 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')){
+      p++;
+      polygon.clear();
+      const long long vertices_so_far = chunk->positions.size() / 3;
+      long long index;
+      while(parse_integer(&p, line_end, &index)){
+        if(index == 0){
+          chunk->ok = false;
+          return;
+        }
+        obj_index corner;
+        corner.relative = index < 0;
+        corner.value = index < 0 ? vertices_so_far + index : index - 1;
+        polygon.push_back(corner);
+        // skip the texture coordinate and normal indices
+        while(p < line_end && *p != ' ' && *p != '\t'){
+          p++;
+        }
+      }
+      triangulate(polygon, &chunk->corners);
+    }
+    p = line_end + 1;
+  }
+}
+
+static bool
+import_obj(const std::vector<char> &contents,
+           mesh_data *mesh)
+{
+  const size_t size = contents.size() - 1;
+  const int threads = number_of_threads();
+  const std::vector<size_t> boundaries = split_into_lines(&contents[0], size, threads);
+  std::vector<obj_chunk> chunks(threads);
+  parallel_for(threads, [&](int i){
+      parse_obj_chunk(&contents[0] + boundaries[i],
+                      &contents[0] + boundaries[i + 1],
+                      &chunks[i]);
+    });
+
+  // where each chunk's vertices and corners begin
+  std::vector<size_t> first_vertex(threads + 1, 0);
+  std::vector<size_t> first_corner(threads + 1, 0);
+  for(int i = 0; i < threads; i++){
+    if(!chunks[i].ok){
+      return false;
+    }
+    first_vertex[i + 1] = first_vertex[i] + chunks[i].positions.size() / 3;
+    first_corner[i + 1] = first_corner[i] + chunks[i].corners.size();
+  }
+  const long long number_of_vertices = (long long) first_vertex[threads];
+  mesh->vertices.resize(number_of_vertices * 3);
+  mesh->indices.resize(first_corner[threads]);
+  std::vector<char> in_range(threads, 1);
+  parallel_for(threads, [&](int i){
+      const obj_chunk &chunk = chunks[i];
+      std::copy(chunk.positions.begin(),
+                chunk.positions.end(),
+                mesh->vertices.begin() + first_vertex[i] * 3);
+      for(size_t c = 0; c < chunk.corners.size(); c++){
+        long long index = chunk.corners[c].value;
+        if(chunk.corners[c].relative){
+          index += (long long) first_vertex[i];
+        }
+        if(index < 0 || index >= number_of_vertices){
+          in_range[i] = 0;
+          index = 0;
+        }
+        mesh->indices[first_corner[i] + c] = (uint32_t) index;
+      }
+    });
+  for(int i = 0; i < threads; i++){
+    if(!in_range[i]){
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * PLY, in ASCII or in binary little-endian
+ */
+
+enum ply_type {
+  PLY_INT8,
+  PLY_UINT8,
+  PLY_INT16,
+  PLY_UINT16,
+  PLY_INT32,
+  PLY_UINT32,
+  PLY_FLOAT32,
+  PLY_FLOAT64,
+  PLY_UNKNOWN
+};
+
+static const int ply_type_bytes[] = {1, 1, 2, 2, 4, 4, 4, 8};
+
+struct ply_property {
+  std::string name;
+  ply_type type;          // the type of the items, if a list
+  bool list;
+  ply_type count_type;
+};
+
+struct ply_element {
+  std::string name;
+  uint64_t count;
+  std::vector<ply_property> properties;
+};
+
+static ply_type
+parse_ply_type(const std::string &name)
+{
+  static const char *names[][2] = {
+    {"char", "int8"},
+    {"uchar", "uint8"},
+    {"short", "int16"},
+    {"ushort", "uint16"},
+    {"int", "int32"},
+    {"uint", "uint32"},
+    {"float", "float32"},
+    {"double", "float64"}
+  };
+  for(int i = 0; i < PLY_UNKNOWN; i++){
+    if(name == names[i][0] || name == names[i][1]){
+      return (ply_type) i;
+    }
+  }
+  return PLY_UNKNOWN;
+}
+
+static double
+read_ply_scalar(const char *p,
+                ply_type type)
+{
+  // the file is little-endian, as is every machine this is built for
+  switch(type){
+  case PLY_INT8:    { int8_t v;   memcpy(&v, p, 1); return v; }
+  case PLY_UINT8:   { uint8_t v;  memcpy(&v, p, 1); return v; }
+  case PLY_INT16:   { int16_t v;  memcpy(&v, p, 2); return v; }
+  case PLY_UINT16:  { uint16_t v; memcpy(&v, p, 2); return v; }
+  case PLY_INT32:   { int32_t v;  memcpy(&v, p, 4); return v; }
+  case PLY_UINT32:  { uint32_t v; memcpy(&v, p, 4); return v; }
+  case PLY_FLOAT32: { float v;    memcpy(&v, p, 4); return v; }
+  default:          { double v;   memcpy(&v, p, 8); return v; }
+  }
+}
+
+// the index of the property named "name", or -1
+static int
+find_property(const ply_element &element,
+              const char *name)
+{
+  for(size_t i = 0; i < element.properties.size(); i++){
+    if(element.properties[i].name == name){
+      return (int) i;
+    }
+  }
+  return -1;
+}
+
+static bool
+is_ply_integer(ply_type type)
+{
+  return type < PLY_FLOAT32;
+}
+
+static bool
+is_face_indices(const ply_property &property)
+{
+  return property.list
+    && (property.name == "vertex_indices" || property.name == "vertex_index");
+}
+
+struct ply_chunk {
+  std::vector<float> positions;
+  std::vector<uint32_t> corners;
+  bool ok;
+};
+
+// parse the ASCII lines of one chunk, the first of which is line
+// "first_line" of the body
+static void
+parse_ply_ascii_chunk(const char *p,
+                      const char *end,
+                      uint64_t first_line,
+                      const std::vector<ply_element> &elements,
+                      ply_chunk *chunk)
+{
+  chunk->ok = true;
+  std::vector<uint32_t> polygon;
+  uint64_t line = first_line;
+  while(p < end){
+    const char *line_end = end_of_line(p, end);
+    // find the element to which this line belongs
+    uint64_t element_start = 0;
+    size_t e = 0;
+    while(e < elements.size() && line >= element_start + elements[e].count){
+      element_start += elements[e].count;
+      e++;
+    }
+    if(e < elements.size()
+       && (elements[e].name == "vertex" || elements[e].name == "face")){
+      const ply_element &element = elements[e];
+      polygon.clear();
+      float position[3] = {0.0f, 0.0f, 0.0f};
+      for(size_t i = 0; chunk->ok && i < element.properties.size(); i++){
+        const ply_property &property = element.properties[i];
+        if(property.list){
+          long long count;
+          chunk->ok = parse_integer(&p, line_end, &count) && count >= 0;
+          for(long long k = 0; chunk->ok && k < count; k++){
+            if(is_ply_integer(property.type)){
+              // exactly; a float holds integers only up to 2^24
+              long long index;
+              chunk->ok = parse_integer(&p, line_end, &index);
+              if(is_face_indices(property)){
+                polygon.push_back((uint32_t) index);
+              }
+            }
+            else{
+              float value;
+              chunk->ok = parse_float(&p, line_end, &value);
+              if(is_face_indices(property)){
+                polygon.push_back((uint32_t) value);
+              }
+            }
+          }
+        }
+        else{
+          float value;
+          if(is_ply_integer(property.type)){
+            long long integer;
+            chunk->ok = parse_integer(&p, line_end, &integer);
+            value = (float) integer;
+          }
+          else{
+            chunk->ok = parse_float(&p, line_end, &value);
+          }
+          if(property.name.size() == 1 && property.name[0] >= 'x' && property.name[0] <= 'z'){
+            position[property.name[0] - 'x'] = value;
+          }
+        }
+      }
+      if(!chunk->ok){
+        return;
+      }
+      if(element.name == "vertex"){
+        chunk->positions.insert(chunk->positions.end(), position, position + 3);
+      }
+      else{
+        triangulate(polygon, &chunk->corners);
+      }
+    }
+    line++;
+    p = line_end + 1;
+  }
+}
+
+static bool
+import_ply_ascii(const char *body,
+                 const char *end,
+                 const std::vector<ply_element> &elements,
+                 mesh_data *mesh)
+{
+  const int threads = number_of_threads();
+  const std::vector<size_t> boundaries = split_into_lines(body, end - body, threads);
+  // number the lines, so that each chunk knows to which element its lines belong
+  std::vector<uint64_t> lines(threads + 1, 0);
+  parallel_for(threads, [&](int i){
+      uint64_t count = 0;
+      const char *p = body + boundaries[i];
+      const char *chunk_end = body + boundaries[i + 1];
+      while((p = (const char *) memchr(p, '\n', chunk_end - p)) != NULL){
+        count++;
+        p++;
+      }
+      lines[i + 1] = count;
+    });
+  for(int i = 0; i < threads; i++){
+    lines[i + 1] += lines[i];
+  }
+  std::vector<ply_chunk> chunks(threads);
+  parallel_for(threads, [&](int i){
+      parse_ply_ascii_chunk(body + boundaries[i],
+                            body + boundaries[i + 1],
+                            lines[i],
+                            elements,
+                            &chunks[i]);
+    });
+  for(int i = 0; i < threads; i++){
+    if(!chunks[i].ok){
+      return false;
+    }
+    mesh->vertices.insert(mesh->vertices.end(),
+                          chunks[i].positions.begin(),
+                          chunks[i].positions.end());
+    mesh->indices.insert(mesh->indices.end(),
+                         chunks[i].corners.begin(),
+                         chunks[i].corners.end());
+  }
+  return true;
+}
+
+static bool
+import_ply_binary(const char *p,
+                  const char *end,
+                  const std::vector<ply_element> &elements,
+                  mesh_data *mesh)
+{
+  std::vector<uint32_t> polygon;
+  for(size_t e = 0; e < elements.size(); e++){
+    const ply_element &element = elements[e];
+    bool fixed_size = true;
+    uint64_t stride = 0;
+    for(size_t i = 0; i < element.properties.size(); i++){
+      fixed_size = fixed_size && !element.properties[i].list;
+      stride += ply_type_bytes[element.properties[i].type];
+    }
+    if(fixed_size){
+      if(element.count > (uint64_t) (end - p) / std::max<uint64_t>(stride, 1)){
+        return false;
+      }
+      if(element.name == "vertex"){
+        // every vertex is the same size, so they are read in parallel
+        int offsets[3];
+        ply_type types[3];
+        for(int axis = 0; axis < 3; axis++){
+          const char name[2] = {(char) ('x' + axis), '\0'};
+          const int property = find_property(element, name);
+          if(property < 0){
+            return false;
+          }
+          offsets[axis] = 0;
+          for(int i = 0; i < property; i++){
+            offsets[axis] += ply_type_bytes[element.properties[i].type];
+          }
+          types[axis] = element.properties[property].type;
+        }
+        const size_t first = mesh->vertices.size() / 3;
+        mesh->vertices.resize((first + element.count) * 3);
+        const int threads = number_of_threads();
+        const char *vertices = p;
+        parallel_for(threads, [&](int t){
+            const uint64_t begin = element.count * t / threads;
+            const uint64_t finish = element.count * (t + 1) / threads;
+            for(uint64_t v = begin; v < finish; v++){
+              for(int axis = 0; axis < 3; axis++){
+                mesh->vertices[(first + v) * 3 + axis] = (float)
+                  read_ply_scalar(vertices + v * stride + offsets[axis], types[axis]);
+              }
+            }
+          });
+      }
+      p += element.count * stride;
+      continue;
+    }
+    // elements containing lists vary in size, and are read in order
+    for(uint64_t n = 0; n < element.count; n++){
+      polygon.clear();
+      for(size_t i = 0; i < element.properties.size(); i++){
+        const ply_property &property = element.properties[i];
+        if(!property.list){
+          if(end - p < ply_type_bytes[property.type]){
+            return false;
+          }
+          p += ply_type_bytes[property.type];
+          continue;
+        }
+        if(end - p < ply_type_bytes[property.count_type]){
+          return false;
+        }
+        const double count = read_ply_scalar(p, property.count_type);
+        p += ply_type_bytes[property.count_type];
+        const int item_bytes = ply_type_bytes[property.type];
+        if(count < 0 || count > (double) ((end - p) / item_bytes)){
+          return false;
+        }
+        for(int k = 0; k < (int) count; k++){
+          if(is_face_indices(property)){
+            polygon.push_back((uint32_t) read_ply_scalar(p, property.type));
+          }
+          p += item_bytes;
+        }
+      }
+      if(element.name == "face"){
+        triangulate(polygon, &mesh->indices);
+      }
+    }
+  }
+  return true;
+}
+
+static bool
+import_ply(const std::vector<char> &contents,
+           mesh_data *mesh)
+{
+  const char *p = &contents[0];
+  const char *end = p + contents.size() - 1;
+  bool binary = false;
+  std::vector<ply_element> elements;
+  bool first_line = true;
+  for(;;){
+    if(p >= end){
+      return false;
+    }
+    const char *line_end = end_of_line(p, end);
+    std::string line(p, line_end);
+    p = line_end + 1;
+    if(!line.empty() && line[line.size() - 1] == '\r'){
+      line.erase(line.size() - 1);
+    }
+    char word[3][64];
+    unsigned long long count;
+    if(first_line){
+      if(line != "ply"){
+        return false;
+      }
+      first_line = false;
+    }
+    else if(line == "end_header"){
+      break;
+    }
+    else if(sscanf(line.c_str(), "format %63s", word[0]) == 1){
+      if(strcmp(word[0], "binary_little_endian") == 0){
+        binary = true;
+      }
+      else if(strcmp(word[0], "ascii") != 0){
+        fprintf(stderr, "Error: PLY format %s is not supported\n", word[0]);
+        return false;
+      }
+    }
+    else if(sscanf(line.c_str(), "element %63s %llu", word[0], &count) == 2){
+      ply_element element;
+      element.name = word[0];
+      element.count = count;
+      elements.push_back(element);
+    }
+    else if(sscanf(line.c_str(), "property list %63s %63s %63s",
+                   word[0], word[1], word[2]) == 3){
+      ply_property property;
+      property.list = true;
+      property.count_type = parse_ply_type(word[0]);
+      property.type = parse_ply_type(word[1]);
+      property.name = word[2];
+      if(elements.empty()
+         || property.count_type == PLY_UNKNOWN
+         || property.type == PLY_UNKNOWN){
+        return false;
+      }
+      elements.back().properties.push_back(property);
+    }
+    else if(sscanf(line.c_str(), "property %63s %63s", word[0], word[1]) == 2){
+      ply_property property;
+      property.list = false;
+      property.type = parse_ply_type(word[0]);
+      property.count_type = PLY_UNKNOWN;
+      property.name = word[1];
+      if(elements.empty() || property.type == PLY_UNKNOWN){
+        return false;
+      }
+      elements.back().properties.push_back(property);
+    }
+  }
+  const bool ok = binary
+    ? import_ply_binary(p, end, elements, mesh)
+    : import_ply_ascii(p, end, elements, mesh);
+  if(!ok){
+    return false;
+  }
+  const uint64_t number_of_vertices = mesh->vertices.size() / 3;
+  for(size_t i = 0; i < mesh->indices.size(); i++){
+    if(mesh->indices[i] >= number_of_vertices){
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool
+has_extension(const char *path,
+              const char *extension)
+{
+  const size_t length = strlen(path);
+  const size_t extension_length = strlen(extension);
+  if(length < extension_length){
+    return false;
+  }
+  for(size_t i = 0; i < extension_length; i++){
+    if(tolower((unsigned char) path[length - extension_length + i]) != extension[i]){
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool
+import_contents(const char *path,
+                const std::vector<char> &contents,
+                mesh_data *mesh)
+{
+  mesh->vertices.clear();
+  mesh->indices.clear();
+  bool ok;
+  if(has_extension(path, ".obj")){
+    ok = import_obj(contents, mesh);
+  }
+  else if(has_extension(path, ".ply")){
+    ok = import_ply(contents, mesh);
+  }
+  else{
+    fprintf(stderr, "Error: %s is neither an OBJ nor a PLY file\n", path);
+    return false;
+  }
+  if(!ok || mesh->vertices.size() / 3 > 0xffffffffULL){
+    fprintf(stderr, "Error: could not import %s\n", path);
+    return false;
+  }
+  mesh_weld(mesh);
+  const size_t number_of_vertices = mesh->vertices.size() / 3;
+  const double acmr_before = mesh_acmr(mesh->indices, number_of_vertices, 16);
+  mesh_optimize(mesh);
+  fprintf(stderr, "mesh: ACMR %.3f before, %.3f after reordering, with a 16 vertex cache\n",
+          acmr_before,
+          mesh_acmr(mesh->indices, number_of_vertices, 16));
+  return true;
+}
+
+bool
+mesh_import(const char *path,
+            mesh_data *mesh)
+{
+  std::vector<char> contents;
+  if(!read_file(path, &contents)){
+    fprintf(stderr, "Error: could not read %s\n", path);
+    return false;
+  }
+  return import_contents(path, contents, mesh);
+}
+
+static int
+number_of_levels_of_detail()
+{
+  return std::max(0, std::min(option_int("MESH_LODS", 3), 8));
+}
+
+// FNV-1a of each megabyte, in parallel, then of those hashes in order
+static uint64_t
+content_hash(const std::vector<char> &contents)
+{
+  const size_t block = 1 << 20;
+  const size_t size = contents.size() - 1;
+  const size_t number_of_blocks = (size + block - 1) / block;
+  std::vector<uint64_t> block_hashes(number_of_blocks);
+  const int threads = number_of_threads();
+  parallel_for(threads, [&](int t){
+      for(size_t b = t; b < number_of_blocks; b += threads){
+        uint64_t hash = 14695981039346656037ULL;
+        const unsigned char *p = (const unsigned char *) &contents[b * block];
+        const size_t n = std::min(block, size - b * block);
+        for(size_t i = 0; i < n; i++){
+          hash = (hash ^ p[i]) * 1099511628211ULL;
+        }
+        block_hashes[b] = hash;
+      }
+    });
+  uint64_t hash = 14695981039346656037ULL;
+  const uint64_t prefix[4] = {importer_version,
+                              MESH_FILE_VERSION,
+                              (uint64_t) number_of_levels_of_detail(),
+                              size};
+  for(int i = 0; i < 4; i++){
+    hash = (hash ^ prefix[i]) * 1099511628211ULL;
+  }
+  for(size_t b = 0; b < number_of_blocks; b++){
+    hash = (hash ^ block_hashes[b]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+bool
+mesh_import_cached(const char *path,
+                   mesh_file *file)
+{
+  const import_clock::time_point start = import_clock::now();
+  std::vector<char> contents;
+  if(!read_file(path, &contents)){
+    fprintf(stderr, "Error: could not read %s\n", path);
+    return false;
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx.mvpmesh",
+           (unsigned long long) content_hash(contents));
+  const std::string cache_path = std::string(option_string("MESH_CACHE", ".")) + name;
+
+  FILE *cached = fopen(cache_path.c_str(), "rb");
+  if(cached != NULL){
+    fclose(cached);
+  }
+  else{
+    std::vector<mesh_data> meshes(1);
+    if(!import_contents(path, contents, &meshes[0])){
+      return false;
+    }
+    contents.clear();
+    // the coarser levels of detail follow the mesh, each with a
+    // quarter of the triangles of the one before
+    for(int level = 1; level <= number_of_levels_of_detail(); level++){
+      const size_t triangles = meshes[level - 1].indices.size() / 3;
+      if(triangles < 16){
+        break;
+      }
+      mesh_data simpler;
+      mesh_simplify(meshes[level - 1], triangles / 4, &simpler);
+      if(simpler.indices.empty() || simpler.indices.size() == meshes[level - 1].indices.size()){
+        break;
+      }
+      mesh_optimize(&simpler);
+      meshes.push_back(mesh_data());
+      meshes.back().vertices.swap(simpler.vertices);
+      meshes.back().indices.swap(simpler.indices);
+    }
+    const mesh_data &mesh = meshes[0];
+    // one white object, so that the converted file is also a scene
+    std::vector<mesh_file_object> objects(1);
+    for(int i = 0; i < 16; i++){
+      objects[0].transform[i] = i % 5 == 0 ? 1.0f : 0.0f;
+    }
+    objects[0].color[0] = objects[0].color[1] = objects[0].color[2] = 1.0f;
+    objects[0].mesh = 0;
+    // write under another name, so that no reader sees a partial file
+    const std::string partial_path = cache_path + ".partial";
+    if(!mesh_file_write(partial_path.c_str(), meshes, objects)){
+      return false;
+    }
+    remove(cache_path.c_str());
+    if(rename(partial_path.c_str(), cache_path.c_str()) != 0){
+      fprintf(stderr, "Error: could not write %s\n", cache_path.c_str());
+      return false;
+    }
+    fprintf(stderr, "mesh: imported %s, %lu vertices, %lu triangles, %lu levels of detail, in %.1f ms\n",
+            path,
+            (unsigned long) (mesh.vertices.size() / 3),
+            (unsigned long) (mesh.indices.size() / 3),
+            (unsigned long) (meshes.size() - 1),
+            std::chrono::duration<double, std::milli>(import_clock::now() - start).count());
+  }
+  if(!mesh_file_open(cache_path.c_str(), file)){
+    return false;
+  }
+  fprintf(stderr, "mesh: mapped %s, for %s, %.1f ms after starting\n",
+          cache_path.c_str(),
+          path,
+          std::chrono::duration<double, std::milli>(import_clock::now() - start).count());
+  return true;
+}
@@ -0,0 +1,44 @@
+#ifndef MESH_IMPORT_H
+#define MESH_IMPORT_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Import of Wavefront OBJ and PLY (ASCII, or binary little-endian)
+ * meshes.
+ *
+ * The file is split into one chunk per thread (MVP_IMPORT_THREADS,
+ * default the number of cores), and the chunks are parsed in parallel.
+ * Polygons are split into triangles, vertices with identical positions
+ * are welded into one, and the triangles and vertices are reordered for
+ * the vertex cache (see "mesh_optimize.h").  Only positions are kept.
+ *
+ * Because parsing hundreds of megabytes of text is slow even on every
+ * core, "mesh_import_cached" writes the result as a mesh file (see
+ * "mesh_file.h") into the directory MVP_MESH_CACHE (default "."),
+ * named after a hash of the source file's contents.  Later runs map
+ * that file instead of parsing the source again.  The converted file's
+ * first mesh is the imported one; it is followed by MVP_MESH_LODS
+ * (default 3) simplified levels of detail, each with a quarter of the
+ * triangles of the one before.
+ */
+
+/* Returns false, after printing the reason to stderr, if "path" cannot
+ * be read or is not a mesh.
+ */
+bool
+mesh_import(const char *path,
+            mesh_data *mesh);
+
+/* map the converted file for "path", importing it first if the cache
+ * has no file for its current contents.
+ */
+bool
+mesh_import_cached(const char *path,
+                   mesh_file *file);
+
+#endif
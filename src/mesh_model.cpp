@@ -0,0 +1,220 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "main.h"
+#include "options.h"
+#include "mesh_file.h"
+#include "mesh_import.h"
+#include "on_demand.h"
+#include "startup.h"
+#include "timeline.h"
+#include "mesh_model.h"
+
+// set once everything below is ready, which may be on another thread
+static std::atomic<bool> active(false);
+// which imports the mesh, if "mesh_model_init_in_background"
+static std::thread importer;
+static mesh_file file;
+// full detail first, then each coarser level of detail
+struct level_of_detail {
+  const float *vertices;
+  const uint32_t *indices;
+  uint64_t number_of_corners;
+};
+static std::vector<level_of_detail> levels;
+// model space = (file's position - center) * scale
+static GLfloat center[3];
+static GLfloat scale = 1.0f;
+
+// counters, in triangles
+static unsigned long long drawn = 0;
+static unsigned long long full_detail = 0;
+
+bool
+mesh_model_requested()
+{
+  return option_string("MESH", NULL) != NULL;
+}
+
+bool
+mesh_model_active()
+{
+  return active.load(std::memory_order_acquire);
+}
+
+bool
+mesh_model_init()
+{
+  if(!mesh_import_cached(option_string("MESH", NULL), &file)){
+    return false;
+  }
+  if(file.header->number_of_meshes == 0 || file.meshes[0].number_of_vertices == 0){
+    fprintf(stderr, "Error: MVP_MESH has no vertices\n");
+    mesh_file_close(&file);
+    return false;
+  }
+  for(uint64_t m = 0; m < file.header->number_of_meshes; m++){
+    if(!mesh_file_indices_valid(file, file.meshes[m])){
+      fprintf(stderr, "Error: MVP_MESH's cache has an index beyond its vertices\n");
+      levels.clear();
+      mesh_file_close(&file);
+      return false;
+    }
+    level_of_detail level;
+    level.vertices = mesh_file_vertices(file, file.meshes[m]);
+    level.indices = mesh_file_indices(file, file.meshes[m]);
+    level.number_of_corners = file.meshes[m].number_of_indices;
+    levels.push_back(level);
+  }
+  const mesh_file_mesh &mesh = file.meshes[0];
+  const float *vertices = levels[0].vertices;
+
+  GLfloat lowest[3], highest[3];
+  for(int axis = 0; axis < 3; axis++){
+    lowest[axis] = highest[axis] = vertices[axis];
+  }
+  for(uint64_t v = 1; v < mesh.number_of_vertices; v++){
+    for(int axis = 0; axis < 3; axis++){
+      lowest[axis] = std::min(lowest[axis], vertices[v * 3 + axis]);
+      highest[axis] = std::max(highest[axis], vertices[v * 3 + axis]);
+    }
+  }
+  GLfloat extent = 0.0f;
+  for(int axis = 0; axis < 3; axis++){
+    center[axis] = (lowest[axis] + highest[axis]) / 2.0f;
+    extent = std::max(extent, highest[axis] - lowest[axis]);
+  }
+  scale = extent > 0.0f ? 2.0f / extent : 1.0f;
+  active.store(true, std::memory_order_release);
+  return true;
+}
+
+static void
+import_in_background()
+{
+  timeline_name_thread("mesh import");
+  timeline_zone zone("import mesh");
+  if(mesh_model_init()){
+    fprintf(stderr, "mesh: imported in the background, %.1f ms after startup\n",
+            startup_milliseconds());
+    // the square is drawn until the next frame
+    on_demand_scene_changed();
+  }
+}
+
+void
+mesh_model_init_in_background()
+{
+  try{
+    importer = std::thread(import_in_background);
+  }
+  catch(const std::system_error &e){
+    fprintf(stderr, "Error: cannot import the mesh in the background: %s\n", e.what());
+    mesh_model_init();
+  }
+}
+
+int
+mesh_model_level(GLfloat ndc_radius)
+{
+  static const double full_detail_pixels = option_double("LOD_PIXELS", 128.0);
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  const double pixels = ndc_radius * viewport[3] / 2.0;
+  int level = 0;
+  // each level has a quarter of the triangles, so is used at half
+  // the size on screen
+  if(pixels > 0.0 && pixels < full_detail_pixels){
+    level = std::min((int) std::log2(full_detail_pixels / pixels),
+                     (int) levels.size() - 1);
+  }
+  drawn += levels[level].number_of_corners / 3;
+  full_detail += levels[0].number_of_corners / 3;
+  return level;
+}
+
+uint64_t
+mesh_model_number_of_corners(int level)
+{
+  return levels[level].number_of_corners;
+}
+
+void
+mesh_model_corner(int level,
+                  uint64_t corner,
+                  GLfloat position[3])
+{
+  const float *v = levels[level].vertices + (uint64_t) levels[level].indices[corner] * 3;
+  position[0] = (v[0] - center[0]) * scale;
+  position[1] = (v[1] - center[1]) * scale;
+  position[2] = (v[2] - center[2]) * scale;
+}
+
+void
+mesh_model_draw()
+{
+  // how large the square's extent of 1 is, once projected
+  GLfloat modelview[16], projection[16];
+  glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+  glGetFloatv(GL_PROJECTION_MATRIX, projection);
+  GLfloat size = 0.0f;
+  for(int column = 0; column < 3; column++){
+    const GLfloat *c = &modelview[column * 4];
+    size = std::max(size, std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]));
+  }
+  const GLfloat w = projection[11] * modelview[14] + projection[15];
+  const level_of_detail &level =
+    levels[mesh_model_level(w > 0.0f ? size * projection[5] / w : 0.0f)];
+
+  glPushMatrix();
+  glScalef(scale, scale, scale);
+  glTranslatef(-center[0], -center[1], -center[2]);
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(/*size*/ 3,
+                  GL_FLOAT,
+                  /*stride*/ 0,
+                  level.vertices);
+  glDrawElements(GL_TRIANGLES,
+                 (GLsizei) level.number_of_corners,
+                 GL_UNSIGNED_INT,
+                 level.indices);
+  glPopClientAttrib();
+  glPopMatrix();
+}
+
+void
+mesh_model_wait()
+{
+  if(importer.joinable()){
+    importer.join();
+  }
+}
+
+void
+mesh_model_shutdown()
+{
+  mesh_model_wait();
+  if(!mesh_model_active()){
+    return;
+  }
+  if(full_detail > 0){
+    fprintf(stderr, "mesh: %lu levels of detail, drew %.1f%% of the full-detail triangles\n",
+            (unsigned long) levels.size(),
+            100.0 * drawn / full_detail);
+  }
+  levels.clear();
+  mesh_file_close(&file);
+  active.store(false);
+}
@@ -0,0 +1,76 @@
+#ifndef MESH_MODEL_H
+#define MESH_MODEL_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+
+/* An imported mesh which takes the place of the square.
+ *
+ * If MVP_MESH=file.obj or MVP_MESH=file.ply is set, the mesh is
+ * imported (or mapped from the cache, see "mesh_import.h") at startup,
+ * centered, and scaled to fit within the square's extent of -1 to 1.
+ * Chapter 16 then transforms its vertices, and chapter 17 draws it,
+ * wherever those chapters draw a square.
+ *
+ * The cache also holds coarser levels of detail (see
+ * "mesh_simplify.h").  Full detail is drawn while the mesh's extent of
+ * 1 covers at least MVP_LOD_PIXELS (default 128) pixels on screen, and
+ * each halving of that size drops one level.
+ */
+
+bool
+mesh_model_requested();
+
+bool
+mesh_model_active();
+
+/* Returns false, after printing the reason to stderr, if the mesh
+ * cannot be loaded.
+ */
+bool
+mesh_model_init();
+
+/* as "mesh_model_init", on a thread of its own, so that the square is
+ * drawn until the mesh is ready; a mesh which cannot be loaded leaves
+ * the square in its place
+ */
+void
+mesh_model_init_in_background();
+
+/* the level of detail to draw, 0 being full detail, when the mesh's
+ * extent of 1 is "ndc_radius" long in normalized device coordinates
+ */
+int
+mesh_model_level(GLfloat ndc_radius);
+
+/* three corners per triangle */
+uint64_t
+mesh_model_number_of_corners(int level);
+
+/* the position of a corner, in the square's model space */
+void
+mesh_model_corner(int level,
+                  uint64_t corner,
+                  GLfloat position[3]);
+
+/* draw the mesh with the current modelview and projection matrices,
+ * at the level of detail for its size on screen
+ */
+void
+mesh_model_draw();
+
+/* wait for "mesh_model_init_in_background" to finish, as it must
+ * before the timeline is written (see "timeline.h")
+ */
+void
+mesh_model_wait();
+
+void
+mesh_model_shutdown();
+
+#endif
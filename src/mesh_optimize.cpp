@@ -0,0 +1,285 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include "main.h"
+#include "mesh_file.h"
+#include "mesh_optimize.h"
+
+/*
+ * Welding
+ */
+
+struct position_key {
+  uint32_t bits[3];
+  bool operator==(const position_key &other) const
+  {
+    return bits[0] == other.bits[0]
+      && bits[1] == other.bits[1]
+      && bits[2] == other.bits[2];
+  }
+};
+
+struct position_key_hash {
+  size_t operator()(const position_key &key) const
+  {
+    uint64_t hash = 14695981039346656037ULL;
+    for(int i = 0; i < 3; i++){
+      hash = (hash ^ key.bits[i]) * 1099511628211ULL;
+    }
+    return (size_t) (hash ^ (hash >> 32));
+  }
+};
+
+void
+mesh_weld(mesh_data *mesh)
+{
+  const size_t number_of_vertices = mesh->vertices.size() / 3;
+  std::unordered_map<position_key, uint32_t, position_key_hash> welded;
+  welded.reserve(number_of_vertices);
+  std::vector<uint32_t> remap(number_of_vertices);
+  std::vector<float> vertices;
+  vertices.reserve(mesh->vertices.size());
+  for(size_t v = 0; v < number_of_vertices; v++){
+    position_key key;
+    for(int axis = 0; axis < 3; axis++){
+      // so that 0.0 and -0.0 are welded
+      const float value = mesh->vertices[v * 3 + axis] + 0.0f;
+      memcpy(&key.bits[axis], &value, sizeof(value));
+    }
+    const uint32_t next = (uint32_t) (vertices.size() / 3);
+    std::pair<std::unordered_map<position_key, uint32_t, position_key_hash>::iterator,
+              bool> inserted = welded.insert(std::make_pair(key, next));
+    remap[v] = inserted.first->second;
+    if(inserted.second){
+      vertices.insert(vertices.end(),
+                      mesh->vertices.begin() + v * 3,
+                      mesh->vertices.begin() + v * 3 + 3);
+    }
+  }
+  size_t kept = 0;
+  for(size_t t = 0; t + 2 < mesh->indices.size(); t += 3){
+    const uint32_t a = remap[mesh->indices[t]];
+    const uint32_t b = remap[mesh->indices[t + 1]];
+    const uint32_t c = remap[mesh->indices[t + 2]];
+    if(a == b || b == c || a == c){
+      continue;
+    }
+    mesh->indices[kept++] = a;
+    mesh->indices[kept++] = b;
+    mesh->indices[kept++] = c;
+  }
+  mesh->indices.resize(kept);
+  mesh->vertices.swap(vertices);
+}
+
+void
+mesh_quads_to_triangles(std::vector<uint32_t> *indices)
+{
+  std::vector<uint32_t> triangles;
+  triangles.reserve(indices->size() / 4 * 6);
+  for(size_t q = 0; q + 3 < indices->size(); q += 4){
+    const uint32_t *corners = &(*indices)[q];
+    const uint32_t split[6] = {corners[0], corners[1], corners[2],
+                               corners[0], corners[2], corners[3]};
+    triangles.insert(triangles.end(), split, split + 6);
+  }
+  indices->swap(triangles);
+}
+
+/*
+ * Triangle order, after Forsyth
+ */
+
+// the least recently used cache modelled while ordering
+static const int modelled_cache_size = 32;
+static const float cache_decay_power = 1.5f;
+static const float last_triangle_score = 0.75f;
+static const float valence_boost_scale = 2.0f;
+static const float valence_boost_power = 0.5f;
+
+// how much drawing a triangle which uses vertex "v" now is worth
+static float
+vertex_score(int cache_position,
+             uint32_t remaining_triangles)
+{
+  if(remaining_triangles == 0){
+    return -1.0f;
+  }
+  float score = 0.0f;
+  if(cache_position >= 0){
+    if(cache_position < 3){
+      // the triangle just drawn; a fixed score, so that the order does
+      // not simply fan around one vertex
+      score = last_triangle_score;
+    }
+    else{
+      const float scale = 1.0f / (modelled_cache_size - 3);
+      score = std::pow(1.0f - (cache_position - 3) * scale, cache_decay_power);
+    }
+  }
+  // finish off vertices with few triangles left, so that they need not
+  // be transformed again later
+  return score + valence_boost_scale * std::pow((float) remaining_triangles,
+                                                -valence_boost_power);
+}
+
+static void
+order_triangles(std::vector<uint32_t> *indices,
+                size_t number_of_vertices)
+{
+  const size_t number_of_triangles = indices->size() / 3;
+  const std::vector<uint32_t> &corners = *indices;
+
+  // the triangles of each vertex not yet drawn are
+  // triangles_of[first[v]] .. triangles_of[first[v] + remaining[v] - 1]
+  std::vector<uint32_t> remaining(number_of_vertices, 0);
+  for(size_t i = 0; i < corners.size(); i++){
+    remaining[corners[i]]++;
+  }
+  std::vector<size_t> first(number_of_vertices + 1, 0);
+  for(size_t v = 0; v < number_of_vertices; v++){
+    first[v + 1] = first[v] + remaining[v];
+  }
+  std::vector<uint32_t> triangles_of(corners.size());
+  {
+    std::vector<size_t> next(first.begin(), first.end() - 1);
+    for(size_t i = 0; i < corners.size(); i++){
+      triangles_of[next[corners[i]]++] = (uint32_t) (i / 3);
+    }
+  }
+
+  std::vector<int> cache_position(number_of_vertices, -1);
+  std::vector<float> score(number_of_vertices);
+  for(size_t v = 0; v < number_of_vertices; v++){
+    score[v] = vertex_score(-1, remaining[v]);
+  }
+  std::vector<bool> drawn(number_of_triangles, false);
+
+  std::vector<uint32_t> cache, next_cache;
+  cache.reserve(modelled_cache_size + 3);
+  next_cache.reserve(modelled_cache_size + 3);
+  std::vector<uint32_t> result;
+  result.reserve(corners.size());
+  // where to look for a triangle when none in the cache is left
+  size_t cursor = 0;
+  long best = -1;
+  while(result.size() < corners.size()){
+    if(best < 0){
+      while(drawn[cursor]){
+        cursor++;
+      }
+      best = (long) cursor;
+    }
+    const uint32_t t = (uint32_t) best;
+    drawn[t] = true;
+    next_cache.clear();
+    for(int corner = 0; corner < 3; corner++){
+      const uint32_t v = corners[t * 3 + corner];
+      result.push_back(v);
+      next_cache.push_back(v);
+      // forget "t" among v's remaining triangles
+      uint32_t *own = &triangles_of[first[v]];
+      for(uint32_t i = 0; i < remaining[v]; i++){
+        if(own[i] == t){
+          own[i] = own[remaining[v] - 1];
+          break;
+        }
+      }
+      remaining[v]--;
+    }
+    for(size_t i = 0; i < cache.size(); i++){
+      const uint32_t v = cache[i];
+      if(v != next_cache[0] && v != next_cache[1] && v != next_cache[2]){
+        next_cache.push_back(v);
+      }
+    }
+
+    // rescore the vertices which moved in, within, or out of the
+    // cache, and their triangles
+    best = -1;
+    float best_score = -1.0f;
+    for(size_t i = 0; i < next_cache.size(); i++){
+      const uint32_t v = next_cache[i];
+      cache_position[v] = i < (size_t) modelled_cache_size ? (int) i : -1;
+      score[v] = vertex_score(cache_position[v], remaining[v]);
+    }
+    for(size_t i = 0; i < next_cache.size(); i++){
+      const uint32_t v = next_cache[i];
+      const uint32_t *own = &triangles_of[first[v]];
+      for(uint32_t j = 0; j < remaining[v]; j++){
+        const uint32_t u = own[j];
+        const float s = score[corners[u * 3]] + score[corners[u * 3 + 1]] + score[corners[u * 3 + 2]];
+        if(s > best_score){
+          best_score = s;
+          best = u;
+        }
+      }
+    }
+    if(next_cache.size() > (size_t) modelled_cache_size){
+      next_cache.resize(modelled_cache_size);
+    }
+    cache.swap(next_cache);
+  }
+  indices->swap(result);
+}
+
+// number the vertices in the order in which the triangles first use them
+static void
+order_vertices(mesh_data *mesh)
+{
+  const size_t number_of_vertices = mesh->vertices.size() / 3;
+  std::vector<uint32_t> remap(number_of_vertices, UINT32_MAX);
+  std::vector<float> vertices;
+  vertices.reserve(mesh->vertices.size());
+  for(size_t i = 0; i < mesh->indices.size(); i++){
+    const uint32_t v = mesh->indices[i];
+    if(remap[v] == UINT32_MAX){
+      remap[v] = (uint32_t) (vertices.size() / 3);
+      vertices.insert(vertices.end(),
+                      mesh->vertices.begin() + v * 3,
+                      mesh->vertices.begin() + v * 3 + 3);
+    }
+    mesh->indices[i] = remap[v];
+  }
+  mesh->vertices.swap(vertices);
+}
+
+void
+mesh_optimize(mesh_data *mesh)
+{
+  if(mesh->indices.empty()){
+    return;
+  }
+  order_triangles(&mesh->indices, mesh->vertices.size() / 3);
+  order_vertices(mesh);
+}
+
+double
+mesh_acmr(const std::vector<uint32_t> &indices,
+          size_t number_of_vertices,
+          size_t cache_size)
+{
+  if(indices.size() < 3){
+    return 0.0;
+  }
+  // a vertex is in the cache if fewer than "cache_size" misses have
+  // happened since its own
+  std::vector<uint64_t> missed_at(number_of_vertices, 0);
+  uint64_t misses = 0;
+  for(size_t i = 0; i < indices.size(); i++){
+    const uint32_t v = indices[i];
+    if(missed_at[v] == 0 || misses - missed_at[v] >= cache_size){
+      misses++;
+      missed_at[v] = misses;
+    }
+  }
+  return (double) misses / (indices.size() / 3);
+}
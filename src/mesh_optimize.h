@@ -0,0 +1,47 @@
+#ifndef MESH_OPTIMIZE_H
+#define MESH_OPTIMIZE_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Preparation of indexed meshes for drawing.
+ *
+ * A graphics card transforms each vertex which an index names, unless
+ * that vertex is still in its small cache of recently transformed
+ * vertices.  "mesh_optimize" orders the triangles so that consecutive
+ * triangles share vertices (Forsyth, "Linear-Speed Vertex Cache
+ * Optimisation", 2006), and then orders the vertices by first use, so
+ * that they are also fetched from memory in order.
+ *
+ * The average cache miss ratio (ACMR) is the number of vertices
+ * transformed per triangle: 3 at worst, and about 0.5 at best for a
+ * large regular mesh.
+ */
+
+/* merge vertices with identical positions, and drop the triangles which
+ * that leaves with no area
+ */
+void
+mesh_weld(mesh_data *mesh);
+
+/* replace four indices per quad with six per pair of triangles */
+void
+mesh_quads_to_triangles(std::vector<uint32_t> *indices);
+
+/* reorder the triangles, then the vertices */
+void
+mesh_optimize(mesh_data *mesh);
+
+/* the ACMR of drawing "indices" through a first-in first-out cache of
+ * "cache_size" vertices
+ */
+double
+mesh_acmr(const std::vector<uint32_t> &indices,
+          size_t number_of_vertices,
+          size_t cache_size);
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "main.h"
+#include "options.h"
+#include "mesh_file.h"
+#include "mesh_scene.h"
+
+static bool active = false;
+static mesh_file scene;
+// whether each mesh's indices were checked, on its first draw
+enum {
+  mesh_unchecked,
+  mesh_valid,
+  mesh_invalid
+};
+static std::vector<unsigned char> checked;
+
+bool
+mesh_scene_requested()
+{
+  return option_string("SCENE", NULL) != NULL;
+}
+
+bool
+mesh_scene_active()
+{
+  return active;
+}
+
+bool
+mesh_scene_init()
+{
+  const std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+  const char *path = option_string("SCENE", NULL);
+  if(!mesh_file_open(path, &scene)){
+    return false;
+  }
+  checked.assign(scene.header->number_of_meshes, mesh_unchecked);
+  active = true;
+  fprintf(stderr, "scene: mapped %s, %llu meshes, %llu objects, in %.3f ms\n",
+          path,
+          (unsigned long long) scene.header->number_of_meshes,
+          (unsigned long long) scene.header->number_of_objects,
+          std::chrono::duration<double, std::milli>
+          (std::chrono::steady_clock::now() - start).count());
+  return true;
+}
+
+const mesh_file *
+mesh_scene_file()
+{
+  return active ? &scene : NULL;
+}
+
+void
+mesh_scene_draw()
+{
+  if(!active){
+    return;
+  }
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  for(uint64_t i = 0; i < scene.header->number_of_objects; i++){
+    const mesh_file_object &object = scene.objects[i];
+    const mesh_file_mesh &mesh = scene.meshes[object.mesh];
+    if(checked[object.mesh] == mesh_unchecked){
+      checked[object.mesh] =
+        mesh_file_indices_valid(scene, mesh) ? mesh_valid : mesh_invalid;
+      if(checked[object.mesh] == mesh_invalid){
+        fprintf(stderr, "Error: MVP_SCENE's mesh %u has an index beyond its vertices\n",
+                object.mesh);
+      }
+    }
+    if(checked[object.mesh] == mesh_invalid){
+      continue;
+    }
+    glColor3f(object.color[0], object.color[1], object.color[2]);
+    glPushMatrix();
+    glMultMatrixf(object.transform);
+    glVertexPointer(/*size*/ 3,
+                    GL_FLOAT,
+                    /*stride*/ 0,
+                    mesh_file_vertices(scene, mesh));
+    glDrawElements(GL_TRIANGLES,
+                   (GLsizei) mesh.number_of_indices,
+                   GL_UNSIGNED_INT,
+                   mesh_file_indices(scene, mesh));
+    glPopMatrix();
+  }
+  glPopClientAttrib();
+}
+
+void
+mesh_scene_shutdown()
+{
+  if(!active){
+    return;
+  }
+  mesh_file_close(&scene);
+  checked.clear();
+  active = false;
+}
@@ -0,0 +1,43 @@
+#ifndef MESH_SCENE_H
+#define MESH_SCENE_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include "mesh_file.h"
+
+/* A scene loaded from a mesh file (see "mesh_file.h").
+ *
+ * If MVP_SCENE=file is set, the file is mapped at startup, and each of
+ * its objects is drawn by chapter 17, in world space, alongside the
+ * paddles.  The vertices and indices are handed to OpenGL straight from
+ * the mapping.
+ */
+
+bool
+mesh_scene_requested();
+
+bool
+mesh_scene_active();
+
+/* Returns false, after printing the reason to stderr, if the file
+ * cannot be loaded.
+ */
+bool
+mesh_scene_init();
+
+/* the mapped file, or NULL if none is loaded */
+const mesh_file *
+mesh_scene_file();
+
+/* draw every object, with the current modelview matrix as the camera */
+void
+mesh_scene_draw();
+
+void
+mesh_scene_shutdown();
+
+#endif
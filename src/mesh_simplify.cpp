@@ -0,0 +1,434 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+#include "main.h"
+#include "mesh_file.h"
+#include "mesh_simplify.h"
+
+// how strongly the edges of holes resist being moved
+static const double boundary_weight = 1000.0;
+
+// a symmetric 4x4 matrix: xx xy xz xw yy yz yw zz zw ww
+struct quadric {
+  double a[10];
+};
+
+static void
+add_plane(quadric *q,
+          const double n[3],
+          double d,
+          double weight)
+{
+  q->a[0] += weight * n[0] * n[0];
+  q->a[1] += weight * n[0] * n[1];
+  q->a[2] += weight * n[0] * n[2];
+  q->a[3] += weight * n[0] * d;
+  q->a[4] += weight * n[1] * n[1];
+  q->a[5] += weight * n[1] * n[2];
+  q->a[6] += weight * n[1] * d;
+  q->a[7] += weight * n[2] * n[2];
+  q->a[8] += weight * n[2] * d;
+  q->a[9] += weight * d * d;
+}
+
+// the weighted sum of squared distances from "p" to the planes of "q"
+static double
+quadric_error(const quadric &q,
+              const double p[3])
+{
+  const double *a = q.a;
+  const double error =
+    a[0] * p[0] * p[0] + 2 * a[1] * p[0] * p[1] + 2 * a[2] * p[0] * p[2] + 2 * a[3] * p[0]
+    + a[4] * p[1] * p[1] + 2 * a[5] * p[1] * p[2] + 2 * a[6] * p[1]
+    + a[7] * p[2] * p[2] + 2 * a[8] * p[2]
+    + a[9];
+  return error > 0.0 ? error : 0.0;
+}
+
+// the point of least error, if there is exactly one
+static bool
+quadric_minimum(const quadric &q,
+                double p[3])
+{
+  const double *a = q.a;
+  const double det =
+    a[0] * (a[4] * a[7] - a[5] * a[5])
+    - a[1] * (a[1] * a[7] - a[5] * a[2])
+    + a[2] * (a[1] * a[5] - a[4] * a[2]);
+  const double scale = a[0] + a[4] + a[7];
+  if(std::fabs(det) <= 1e-12 * scale * scale * scale){
+    return false;
+  }
+  // Cramer's rule
+  const double b[3] = {-a[3], -a[6], -a[8]};
+  p[0] = (b[0] * (a[4] * a[7] - a[5] * a[5])
+          - a[1] * (b[1] * a[7] - a[5] * b[2])
+          + a[2] * (b[1] * a[5] - a[4] * b[2])) / det;
+  p[1] = (a[0] * (b[1] * a[7] - b[2] * a[5])
+          - b[0] * (a[1] * a[7] - a[5] * a[2])
+          + a[2] * (a[1] * b[2] - b[1] * a[2])) / det;
+  p[2] = (a[0] * (a[4] * b[2] - a[5] * b[1])
+          - a[1] * (a[1] * b[2] - b[1] * a[2])
+          + b[0] * (a[1] * a[5] - a[4] * a[2])) / det;
+  return true;
+}
+
+static void
+cross(const double u[3],
+      const double v[3],
+      double result[3])
+{
+  result[0] = u[1] * v[2] - u[2] * v[1];
+  result[1] = u[2] * v[0] - u[0] * v[2];
+  result[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+static double
+dot(const double u[3],
+    const double v[3])
+{
+  return u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+}
+
+struct candidate {
+  double cost;
+  // of the edge, to collapse the shorter of equally costly edges first
+  double length;
+  uint32_t a;
+  uint32_t b;
+  uint32_t version_a;
+  uint32_t version_b;
+  double position[3];
+  bool operator<(const candidate &other) const
+  {
+    // so that the cheapest is at the top of the priority queue
+    return cost != other.cost ? cost > other.cost : length > other.length;
+  }
+};
+
+class simplifier {
+public:
+  simplifier(const mesh_data &source):
+    number_of_vertices(source.vertices.size() / 3),
+    positions(source.vertices.begin(), source.vertices.end()),
+    quadrics(number_of_vertices),
+    versions(number_of_vertices, 0),
+    vertex_alive(number_of_vertices, true),
+    triangles(source.indices),
+    triangle_alive(source.indices.size() / 3, true),
+    live_triangles(source.indices.size() / 3),
+    vertex_triangles(number_of_vertices)
+  {
+    for(size_t v = 0; v < number_of_vertices; v++){
+      std::fill(quadrics[v].a, quadrics[v].a + 10, 0.0);
+    }
+    // the edges, and how many triangles use each
+    std::unordered_map<uint64_t, int> edges;
+    for(size_t t = 0; t < triangle_alive.size(); t++){
+      double normal[3];
+      const double area = triangle_normal(t, normal);
+      if(area <= 0.0){
+        // nothing to draw; and, belonging to no vertex, it would never
+        // follow its corners as they collapsed
+        triangle_alive[t] = false;
+        live_triangles--;
+        continue;
+      }
+      const double d = -dot(normal, position(triangles[t * 3]));
+      for(int corner = 0; corner < 3; corner++){
+        const uint32_t v = triangles[t * 3 + corner];
+        add_plane(&quadrics[v], normal, d, area);
+        vertex_triangles[v].push_back((uint32_t) t);
+        edges[edge_key(v, triangles[t * 3 + (corner + 1) % 3])]++;
+      }
+    }
+    // hold the edges of holes in place
+    for(size_t t = 0; t < triangle_alive.size(); t++){
+      double normal[3];
+      if(!triangle_alive[t]){
+        continue;
+      }
+      triangle_normal(t, normal);
+      for(int corner = 0; corner < 3; corner++){
+        const uint32_t a = triangles[t * 3 + corner];
+        const uint32_t b = triangles[t * 3 + (corner + 1) % 3];
+        if(edges[edge_key(a, b)] != 1){
+          continue;
+        }
+        double edge[3], perpendicular[3];
+        for(int axis = 0; axis < 3; axis++){
+          edge[axis] = position(b)[axis] - position(a)[axis];
+        }
+        cross(edge, normal, perpendicular);
+        const double length = std::sqrt(dot(perpendicular, perpendicular));
+        if(length <= 0.0){
+          continue;
+        }
+        for(int axis = 0; axis < 3; axis++){
+          perpendicular[axis] /= length;
+        }
+        const double d = -dot(perpendicular, position(a));
+        const double weight = boundary_weight * dot(edge, edge);
+        add_plane(&quadrics[a], perpendicular, d, weight);
+        add_plane(&quadrics[b], perpendicular, d, weight);
+      }
+    }
+    for(std::unordered_map<uint64_t, int>::const_iterator edge = edges.begin();
+        edge != edges.end();
+        edge++){
+      push_candidate((uint32_t) (edge->first >> 32), (uint32_t) edge->first);
+    }
+  }
+
+  void
+  simplify(size_t target_triangles)
+  {
+    while(live_triangles > target_triangles && !heap.empty()){
+      const candidate c = heap.top();
+      heap.pop();
+      if(!vertex_alive[c.a]
+         || !vertex_alive[c.b]
+         || versions[c.a] != c.version_a
+         || versions[c.b] != c.version_b){
+        continue; // one of its vertices has moved since
+      }
+      if(flips(c.a, c.b, c.position) || flips(c.b, c.a, c.position)){
+        continue;
+      }
+      collapse(c.a, c.b, c.position);
+    }
+  }
+
+  void
+  result(mesh_data *mesh) const
+  {
+    std::vector<uint32_t> remap(number_of_vertices, UINT32_MAX);
+    mesh->vertices.clear();
+    mesh->indices.clear();
+    for(size_t t = 0; t < triangle_alive.size(); t++){
+      if(!triangle_alive[t]){
+        continue;
+      }
+      for(int corner = 0; corner < 3; corner++){
+        const uint32_t v = triangles[t * 3 + corner];
+        if(remap[v] == UINT32_MAX){
+          remap[v] = (uint32_t) (mesh->vertices.size() / 3);
+          for(int axis = 0; axis < 3; axis++){
+            mesh->vertices.push_back((float) positions[v * 3 + axis]);
+          }
+        }
+        mesh->indices.push_back(remap[v]);
+      }
+    }
+  }
+
+private:
+  static uint64_t
+  edge_key(uint32_t a,
+           uint32_t b)
+  {
+    return a < b
+      ? ((uint64_t) a << 32) | b
+      : ((uint64_t) b << 32) | a;
+  }
+
+  const double *
+  position(uint32_t v) const
+  {
+    return &positions[(size_t) v * 3];
+  }
+
+  // the unit normal of a triangle, with one corner moved.  Returns
+  // twice its area
+  double
+  normal_of(const double *p0,
+            const double *p1,
+            const double *p2,
+            double normal[3]) const
+  {
+    double u[3], v[3];
+    for(int axis = 0; axis < 3; axis++){
+      u[axis] = p1[axis] - p0[axis];
+      v[axis] = p2[axis] - p0[axis];
+    }
+    cross(u, v, normal);
+    const double length = std::sqrt(dot(normal, normal));
+    if(length > 0.0){
+      for(int axis = 0; axis < 3; axis++){
+        normal[axis] /= length;
+      }
+    }
+    return length;
+  }
+
+  double
+  triangle_normal(size_t t,
+                  double normal[3]) const
+  {
+    return normal_of(position(triangles[t * 3]),
+                     position(triangles[t * 3 + 1]),
+                     position(triangles[t * 3 + 2]),
+                     normal) / 2.0;
+  }
+
+  void
+  push_candidate(uint32_t a,
+                 uint32_t b)
+  {
+    quadric q;
+    for(int i = 0; i < 10; i++){
+      q.a[i] = quadrics[a].a[i] + quadrics[b].a[i];
+    }
+    candidate c;
+    c.a = a;
+    c.b = b;
+    c.version_a = versions[a];
+    c.version_b = versions[b];
+    c.length = 0.0;
+    for(int axis = 0; axis < 3; axis++){
+      const double d = position(a)[axis] - position(b)[axis];
+      c.length += d * d;
+    }
+    if(quadric_minimum(q, c.position)){
+      c.cost = quadric_error(q, c.position);
+    }
+    else{
+      // no single best point; choose the best of the ends and the middle
+      double middle[3];
+      for(int axis = 0; axis < 3; axis++){
+        middle[axis] = (position(a)[axis] + position(b)[axis]) / 2.0;
+      }
+      const double *choices[3] = {position(a), position(b), middle};
+      c.cost = -1.0;
+      for(int i = 0; i < 3; i++){
+        const double cost = quadric_error(q, choices[i]);
+        if(c.cost < 0.0 || cost < c.cost){
+          c.cost = cost;
+          std::copy(choices[i], choices[i] + 3, c.position);
+        }
+      }
+    }
+    heap.push(c);
+  }
+
+  // true if moving "v" to "p" would turn over one of its triangles
+  // which does not also contain "other"
+  bool
+  flips(uint32_t v,
+        uint32_t other,
+        const double p[3]) const
+  {
+    const std::vector<uint32_t> &around = vertex_triangles[v];
+    for(size_t i = 0; i < around.size(); i++){
+      const uint32_t t = around[i];
+      if(!triangle_alive[t]){
+        continue;
+      }
+      const double *corners[3];
+      bool contains_other = false;
+      for(int corner = 0; corner < 3; corner++){
+        const uint32_t w = triangles[t * 3 + corner];
+        contains_other = contains_other || w == other;
+        corners[corner] = w == v ? p : position(w);
+      }
+      if(contains_other){
+        continue;
+      }
+      double before[3], after[3];
+      triangle_normal(t, before);
+      if(normal_of(corners[0], corners[1], corners[2], after) <= 0.0
+         || dot(before, after) <= 0.0){
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // move "a" to "p", and replace "b" with "a"
+  void
+  collapse(uint32_t a,
+           uint32_t b,
+           const double p[3])
+  {
+    std::copy(p, p + 3, &positions[(size_t) a * 3]);
+    for(int i = 0; i < 10; i++){
+      quadrics[a].a[i] += quadrics[b].a[i];
+    }
+    vertex_alive[b] = false;
+    versions[a]++;
+    versions[b]++;
+    const std::vector<uint32_t> &around_b = vertex_triangles[b];
+    for(size_t i = 0; i < around_b.size(); i++){
+      const uint32_t t = around_b[i];
+      if(!triangle_alive[t]){
+        continue;
+      }
+      uint32_t *corners = &triangles[t * 3];
+      if(corners[0] == a || corners[1] == a || corners[2] == a){
+        triangle_alive[t] = false;
+        live_triangles--;
+        continue;
+      }
+      for(int corner = 0; corner < 3; corner++){
+        if(corners[corner] == b){
+          corners[corner] = a;
+        }
+      }
+      vertex_triangles[a].push_back(t);
+    }
+    vertex_triangles[b].clear();
+
+    // forget a's dead triangles, and queue its edges again
+    std::vector<uint32_t> &around_a = vertex_triangles[a];
+    std::vector<uint32_t> neighbors;
+    size_t kept = 0;
+    for(size_t i = 0; i < around_a.size(); i++){
+      const uint32_t t = around_a[i];
+      if(!triangle_alive[t]){
+        continue;
+      }
+      around_a[kept++] = t;
+      for(int corner = 0; corner < 3; corner++){
+        if(triangles[t * 3 + corner] != a){
+          neighbors.push_back(triangles[t * 3 + corner]);
+        }
+      }
+    }
+    around_a.resize(kept);
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    for(size_t i = 0; i < neighbors.size(); i++){
+      push_candidate(a, neighbors[i]);
+    }
+  }
+
+  size_t number_of_vertices;
+  std::vector<double> positions;
+  std::vector<quadric> quadrics;
+  std::vector<uint32_t> versions;
+  std::vector<bool> vertex_alive;
+  std::vector<uint32_t> triangles;
+  std::vector<bool> triangle_alive;
+  size_t live_triangles;
+  std::vector<std::vector<uint32_t> > vertex_triangles;
+  std::priority_queue<candidate> heap;
+};
+
+void
+mesh_simplify(const mesh_data &source,
+              size_t target_triangles,
+              mesh_data *result)
+{
+  simplifier s(source);
+  s.simplify(target_triangles);
+  s.result(result);
+}
@@ -0,0 +1,26 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Mesh simplification by quadric error metrics (Garland and Heckbert,
+ * "Surface Simplification Using Quadric Error Metrics", 1997).
+ *
+ * Each vertex accumulates the planes of the triangles around it; the
+ * edge whose collapse moves its vertices least far from those planes
+ * is collapsed first, until only "target_triangles" remain.  The edges
+ * of holes are held in place by planes perpendicular to them, and
+ * collapses which would turn a triangle over are refused.
+ */
+
+void
+mesh_simplify(const mesh_data &source,
+              size_t target_triangles,
+              mesh_data *result);
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include "main.h"
+#include "options.h"
+#include "frame_pacing.h"
+#include "timeline.h"
+#include "on_demand.h"
+
+typedef std::chrono::steady_clock on_demand_clock;
+
+// true until the window's contents are up to date
+static bool damaged = true;
+// set by other threads, which cannot touch "damaged"
+static std::atomic<bool> changed(false);
+static bool key_held[GLFW_KEY_LAST + 1];
+static int keys_held = 0;
+static double timeout = 0.0; // seconds, 0 means none
+static on_demand_clock::time_point last_presented;
+
+// counters
+static on_demand_clock::time_point started;
+static on_demand_clock::duration slept = on_demand_clock::duration::zero();
+static unsigned long frames = 0;
+static unsigned long wakeups = 0;
+
+bool
+on_demand_enabled()
+{
+  static const bool result = option_enabled("ON_DEMAND") && !regression_child();
+  return result;
+}
+
+static void
+release_all_keys()
+{
+  for(int key = 0; key <= GLFW_KEY_LAST; key++){
+    key_held[key] = false;
+  }
+  keys_held = 0;
+}
+
+static void
+framebuffer_size_callback(GLFWwindow *window,
+                          int width,
+                          int height)
+{
+  damaged = true;
+}
+
+static void
+window_refresh_callback(GLFWwindow *window)
+{
+  damaged = true;
+}
+
+static void
+window_focus_callback(GLFWwindow *window,
+                      int focused)
+{
+  // a key released in another window is never reported to this one
+  if(!focused){
+    release_all_keys();
+  }
+}
+
+void
+on_demand_init(GLFWwindow *window)
+{
+  if(!on_demand_enabled()){
+    return;
+  }
+  release_all_keys();
+  timeout = option_double("ON_DEMAND_TIMEOUT", 0.0);
+  glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+  glfwSetWindowRefreshCallback(window, window_refresh_callback);
+  glfwSetWindowFocusCallback(window, window_focus_callback);
+  started = last_presented = on_demand_clock::now();
+}
+
+void
+on_demand_key_event(int key,
+                    int action)
+{
+  if(!on_demand_enabled()){
+    return;
+  }
+  damaged = true;
+  if(key < 0 || key > GLFW_KEY_LAST){
+    return;
+  }
+  const bool held = action != GLFW_RELEASE;
+  if(held != key_held[key]){
+    key_held[key] = held;
+    keys_held += held ? 1 : -1;
+  }
+}
+
+void
+on_demand_scene_changed()
+{
+  if(!on_demand_enabled()){
+    return;
+  }
+  changed.store(true);
+  // wake "glfwWaitEvents"
+  glfwPostEmptyEvent();
+}
+
+bool
+on_demand_frame_needed()
+{
+  if(changed.exchange(false)){
+    damaged = true;
+  }
+  if(!on_demand_enabled() || damaged || keys_held > 0){
+    return true;
+  }
+  return timeout > 0.0
+    && on_demand_clock::now() - last_presented >= std::chrono::duration<double>(timeout);
+}
+
+void
+on_demand_wait()
+{
+  timeline_zone zone("wait for events");
+  const on_demand_clock::time_point before = on_demand_clock::now();
+  if(timeout > 0.0){
+    const double remaining =
+      timeout - std::chrono::duration<double>(before - last_presented).count();
+    glfwWaitEventsTimeout(remaining > 0.0 ? remaining : 0.0);
+  }
+  else{
+    glfwWaitEvents();
+  }
+  slept += on_demand_clock::now() - before;
+  wakeups++;
+  // the time asleep is not a frame interval
+  frame_pacing_idle();
+}
+
+void
+on_demand_frame_presented()
+{
+  if(!on_demand_enabled()){
+    return;
+  }
+  damaged = false;
+  last_presented = on_demand_clock::now();
+  frames++;
+}
+
+void
+on_demand_report()
+{
+  if(!on_demand_enabled() || frames == 0){
+    return;
+  }
+  const double total = std::chrono::duration<double>(on_demand_clock::now() - started).count();
+  fprintf(stderr,
+          "on demand: %lu frames in %.1f s, asleep %.1f%% of the time, %lu wakeups\n",
+          frames,
+          total,
+          total > 0.0 ? 100.0 * std::chrono::duration<double>(slept).count() / total : 0.0,
+          wakeups);
+}
@@ -0,0 +1,60 @@
+#ifndef ON_DEMAND_H
+#define ON_DEMAND_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Rendering on demand.
+ *
+ * Every chapter's state changes only while a key is held, so a frame
+ * which follows no key, resize, or exposure of the window is identical
+ * to the one before it.  If MVP_ON_DEMAND=1 is set, such frames are not
+ * rendered; the event loop instead sleeps in "glfwWaitEvents" until
+ * the window is damaged or a key is pressed.  While any key is held,
+ * frames are rendered continuously, as the chapters animate.
+ *
+ * MVP_ON_DEMAND_TIMEOUT, in seconds, if set, renders a frame after
+ * that long without any, for displays which must be refreshed.
+ *
+ * Not used by regression runs, whose input is scripted.  How much of
+ * the time the loop slept is printed at exit.
+ */
+
+bool
+on_demand_enabled();
+
+/* install the window's resize and exposure callbacks */
+void
+on_demand_init(GLFWwindow *window);
+
+/* call from the GLFW key callback */
+void
+on_demand_key_event(int key,
+                    int action);
+
+/* what is drawn changed other than by a key, e.g. a mesh finished
+ * loading; may be called from any thread
+ */
+void
+on_demand_scene_changed();
+
+/* false if the next frame would be identical to the last */
+bool
+on_demand_frame_needed();
+
+/* sleep until there is an event */
+void
+on_demand_wait();
+
+/* call once the frame has been presented, before polling for events */
+void
+on_demand_frame_presented();
+
+void
+on_demand_report();
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include "options.h"
+
+// those given on the command line, by name
+static std::map<std::string, std::string> arguments;
+
+bool
+options_parse_arguments(int argc,
+                        char *argv[])
+{
+  for(int i = 1; i < argc; i++){
+    const char *argument = argv[i];
+    if(isdigit((unsigned char) argument[0])){
+      arguments["CHAPTER"] = argument;
+      continue;
+    }
+    if(strncmp(argument, "--", 2) != 0 || argument[2] == '\0'){
+      fprintf(stderr, "Error: cannot understand the argument \"%s\"\n", argument);
+      return false;
+    }
+    // "--fast-start" is FAST_START
+    std::string name;
+    const char *c = argument + 2;
+    for(; *c && *c != '='; c++){
+      name += *c == '-' ? '_' : (char) toupper((unsigned char) *c);
+    }
+    arguments[name] = *c == '=' ? c + 1 : "1";
+  }
+  return true;
+}
+
+void
+options_to_environment()
+{
+  std::map<std::string, std::string>::const_iterator given = arguments.begin();
+  for(; given != arguments.end(); ++given){
+    const std::string variable = "MVP_" + given->first;
+#ifdef _WINDOWS
+    _putenv_s(variable.c_str(), given->second.c_str());
+#else
+    setenv(variable.c_str(), given->second.c_str(), /*overwrite*/ 1);
+#endif
+  }
+}
+
+const char *
+option_string(const char *name,
+              const char *default_value)
+{
+  const std::map<std::string, std::string>::const_iterator given = arguments.find(name);
+  if(given != arguments.end()){
+    return given->second.empty() ? default_value : given->second.c_str();
+  }
+  std::string variable = std::string("MVP_") + name;
+  const char *value = getenv(variable.c_str());
+  if(value == NULL || *value == '\0'){
+    return default_value;
+  }
+  return value;
+}
+
+bool
+option_enabled(const char *name)
+{
+  const char *value = option_string(name, NULL);
+  if(value == NULL){
+    return false;
+  }
+  // "0", "no", and "off" turn an option off explicitly
+  return !(0 == strcmp(value, "0")
+           || 0 == strcmp(value, "no")
+           || 0 == strcmp(value, "off"));
+}
+
+int
+option_int(const char *name,
+           int default_value)
+{
+  const char *value = option_string(name, NULL);
+  if(value == NULL){
+    return default_value;
+  }
+  char *end;
+  long result = strtol(value, &end, 10);
+  return (end == value) ? default_value : (int) result;
+}
+
+double
+option_double(const char *name,
+              double default_value)
+{
+  const char *value = option_string(name, NULL);
+  if(value == NULL){
+    return default_value;
+  }
+  char *end;
+  double result = strtod(value, &end);
+  return (end == value) ? default_value : result;
+}
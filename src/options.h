@@ -0,0 +1,49 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Runtime options.  The option "NAME" is read from the
+ * environment variable "MVP_NAME".  Unset options take the
+ * supplied default value.
+ *
+ * Options may also be given on the command line, where they take
+ * precedence over the environment: "--fast-start" sets FAST_START to
+ * 1, "--trace=out.json" sets TRACE, and a bare number, as in
+ * "modelviewprojection 16", sets CHAPTER.
+ */
+
+/* returns false, after printing the reason to stderr, if an argument
+ * is not understood
+ */
+bool
+options_parse_arguments(int argc,
+                        char *argv[]);
+
+/* set "MVP_NAME" for each option given on the command line, so that
+ * programs run from this one see them too
+ */
+void
+options_to_environment();
+
+bool
+option_enabled(const char *name);
+
+int
+option_int(const char *name,
+           int default_value);
+
+double
+option_double(const char *name,
+              double default_value);
+
+const char *
+option_string(const char *name,
+              const char *default_value);
+
+#endif
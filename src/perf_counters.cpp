@@ -0,0 +1,294 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "main.h"
+#include "options.h"
+#include "perf_counters.h"
+
+enum {
+  counter_cycles,
+  counter_instructions,
+  counter_cache_misses,
+  counter_branch_misses,
+  number_of_counters
+};
+
+static const char *counter_names[number_of_counters] = {
+  "cycles", "instructions", "cache misses", "branch misses"
+};
+
+// chapters beyond this are not counted
+static const int max_chapters = 32;
+
+static bool active = false;
+static int leader = -1;
+static int descriptors[number_of_counters] = {-1, -1, -1, -1};
+// where each counter is in a read of the group, or -1 if unavailable
+static int position[number_of_counters] = {-1, -1, -1, -1};
+static int number_open = 0;
+
+// the group's values at "perf_counters_begin"
+static uint64_t begun[3 + number_of_counters];
+static bool counting = false;
+
+struct chapter_counts {
+  double values[number_of_counters];
+  unsigned long frames;
+  double most_cycles;
+};
+// the current frame's, and the totals
+static chapter_counts this_frame[max_chapters];
+static bool drawn_this_frame[max_chapters];
+static chapter_counts totals[max_chapters];
+static unsigned long frame_number = 0;
+static FILE *csv = NULL;
+
+bool
+perf_counters_enabled()
+{
+  static const bool result = option_enabled("PERF_COUNTERS");
+  return result;
+}
+
+#ifdef __linux__
+static int
+open_counter(uint64_t config,
+             int group)
+{
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  // the group starts together, once every counter is open
+  attr.disabled = group == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP
+    | PERF_FORMAT_TOTAL_TIME_ENABLED
+    | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return (int) syscall(__NR_perf_event_open,
+                       &attr,
+                       /*pid, this thread*/ 0,
+                       /*any cpu*/ -1,
+                       group,
+                       /*flags*/ 0);
+}
+
+// number of counters, time enabled, time running, then the counters
+static bool
+read_group(uint64_t values[3 + number_of_counters])
+{
+  const ssize_t wanted = (ssize_t) ((3 + number_open) * sizeof(uint64_t));
+  return read(leader, values, wanted) == wanted;
+}
+#endif
+
+void
+perf_counters_init()
+{
+  if(!perf_counters_enabled()){
+    return;
+  }
+#ifdef __linux__
+  static const uint64_t configs[number_of_counters] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+  };
+  for(int c = 0; c < number_of_counters; c++){
+    const int fd = open_counter(configs[c], leader);
+    if(fd < 0){
+      fprintf(stderr,
+              "perf counters: cannot count %s (%s)\n",
+              counter_names[c],
+              strerror(errno));
+      continue;
+    }
+    if(leader == -1){
+      leader = fd;
+    }
+    descriptors[c] = fd;
+    position[c] = number_open++;
+  }
+  if(leader == -1){
+    fprintf(stderr,
+            "perf counters: unavailable; see /proc/sys/kernel/perf_event_paranoid\n");
+    return;
+  }
+  ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  const char *path = option_string("PERF_COUNTERS_CSV", NULL);
+  if(path){
+    csv = fopen(path, "w");
+    if(!csv){
+      fprintf(stderr, "perf counters: cannot write %s (%s)\n", path, strerror(errno));
+    }
+    else{
+      fprintf(csv, "frame,chapter,cycles,instructions,cache_misses,branch_misses\n");
+    }
+  }
+  active = true;
+#else
+  fprintf(stderr, "perf counters: available only on Linux\n");
+#endif
+}
+
+void
+perf_counters_begin()
+{
+#ifdef __linux__
+  if(!active){
+    return;
+  }
+  counting = read_group(begun);
+#endif
+}
+
+void
+perf_counters_end(int chapter)
+{
+#ifdef __linux__
+  if(!active || !counting){
+    return;
+  }
+  counting = false;
+  uint64_t ended[3 + number_of_counters];
+  if(!read_group(ended) || chapter < 0 || chapter >= max_chapters){
+    return;
+  }
+  const uint64_t enabled = ended[1] - begun[1];
+  const uint64_t running = ended[2] - begun[2];
+  if(running == 0){
+    // never scheduled while drawing; nothing is known
+    return;
+  }
+  // counted for only part of the time, if the counters were shared
+  const double scale = (double) enabled / (double) running;
+  chapter_counts &counts = this_frame[chapter];
+  for(int c = 0; c < number_of_counters; c++){
+    if(position[c] >= 0){
+      counts.values[c] += scale * (double) (ended[3 + position[c]] - begun[3 + position[c]]);
+    }
+  }
+  drawn_this_frame[chapter] = true;
+#else
+  (void) chapter;
+#endif
+}
+
+void
+perf_counters_end_frame()
+{
+  if(!active){
+    return;
+  }
+  for(int chapter = 0; chapter < max_chapters; chapter++){
+    if(!drawn_this_frame[chapter]){
+      continue;
+    }
+    chapter_counts &counts = this_frame[chapter];
+    chapter_counts &total = totals[chapter];
+    for(int c = 0; c < number_of_counters; c++){
+      total.values[c] += counts.values[c];
+    }
+    total.frames++;
+    if(counts.values[counter_cycles] > total.most_cycles){
+      total.most_cycles = counts.values[counter_cycles];
+    }
+    if(csv){
+      fprintf(csv, "%lu,%d", frame_number, chapter);
+      for(int c = 0; c < number_of_counters; c++){
+        if(position[c] >= 0){
+          fprintf(csv, ",%.0f", counts.values[c]);
+        }
+        else{
+          fprintf(csv, ",");
+        }
+      }
+      fprintf(csv, "\n");
+    }
+    memset(&counts, 0, sizeof(counts));
+    drawn_this_frame[chapter] = false;
+  }
+  frame_number++;
+}
+
+void
+perf_counters_shutdown()
+{
+  if(!active){
+    return;
+  }
+  for(int chapter = 0; chapter < max_chapters; chapter++){
+    const chapter_counts &total = totals[chapter];
+    if(total.frames == 0){
+      continue;
+    }
+    std::vector<std::string> parts;
+    char part[128];
+    for(int c = 0; c < number_of_counters; c++){
+      if(position[c] >= 0){
+        snprintf(part, sizeof(part), "%.0f %s", total.values[c] / total.frames, counter_names[c]);
+        parts.push_back(part);
+      }
+    }
+    const double cycles = total.values[counter_cycles];
+    const double instructions = total.values[counter_instructions];
+    if(position[counter_cycles] >= 0 && position[counter_instructions] >= 0 && cycles > 0.0){
+      snprintf(part, sizeof(part), "%.2f instructions per cycle", instructions / cycles);
+      parts.push_back(part);
+    }
+    if(position[counter_instructions] >= 0 && instructions > 0.0){
+      for(int c = counter_cache_misses; c <= counter_branch_misses; c++){
+        if(position[c] >= 0){
+          snprintf(part, sizeof(part),
+                   "%.2f %s per 1000 instructions",
+                   1000.0 * total.values[c] / instructions,
+                   counter_names[c]);
+          parts.push_back(part);
+        }
+      }
+    }
+    if(position[counter_cycles] >= 0){
+      snprintf(part, sizeof(part), "at most %.0f cycles in a frame", total.most_cycles);
+      parts.push_back(part);
+    }
+    fprintf(stderr, "perf counters: chapter %d, per frame of %lu: ", chapter, total.frames);
+    for(size_t p = 0; p < parts.size(); p++){
+      fprintf(stderr, "%s%s", p == 0 ? "" : ", ", parts[p].c_str());
+    }
+    fprintf(stderr, "\n");
+  }
+#ifdef __linux__
+  for(int c = 0; c < number_of_counters; c++){
+    if(descriptors[c] >= 0){
+      close(descriptors[c]);
+      descriptors[c] = -1;
+    }
+  }
+#endif
+  leader = -1;
+  if(csv){
+    fclose(csv);
+    csv = NULL;
+  }
+  active = false;
+}
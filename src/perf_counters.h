@@ -0,0 +1,80 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* The processor's own counts of what drawing each chapter cost.
+ *
+ * On Linux, "perf_event_open" counts, for this thread alone and in
+ * user space only, the cycles, instructions, cache misses and branch
+ * misses spent in "render_scene", per chapter, and per frame.  From
+ * them, the summary printed to stderr at exit gives each chapter's
+ * instructions per cycle, and misses per thousand instructions: a
+ * loop which retires few instructions per cycle, and misses the cache
+ * often, waits on memory, and would gain more from a better layout of
+ * its data than from SIMD; one with a high rate and few misses is
+ * bound by its arithmetic.
+ *
+ * The four counters are opened as a group, so that they count over
+ * exactly the same instructions.  If the kernel has more groups than
+ * counters to schedule, each is counted only part of the time, and
+ * the counts are scaled up to the whole.  Containers and virtual
+ * machines often allow no counters at all (see
+ * /proc/sys/kernel/perf_event_paranoid), or only some; those which
+ * cannot be opened are reported as unavailable and left out, and the
+ * program runs as usual.
+ *
+ * Enabled by setting MVP_PERF_COUNTERS=1 in the environment.  If
+ * MVP_PERF_COUNTERS_CSV names a file, each frame's counts, per
+ * chapter, are written to it.  With the render thread (see
+ * "render_thread.h"), only the main thread's work is counted.
+ */
+
+bool
+perf_counters_enabled();
+
+/* open the counters, or say why they cannot be */
+void
+perf_counters_init();
+
+/* count from here until "perf_counters_end", and add the counts to
+ * "chapter"
+ */
+void
+perf_counters_begin();
+
+void
+perf_counters_end(int chapter);
+
+/* counts the enclosing scope */
+class perf_counters_scope {
+public:
+  explicit perf_counters_scope(int the_chapter):
+    chapter(the_chapter)
+  {
+    perf_counters_begin();
+  }
+  ~perf_counters_scope()
+  {
+    perf_counters_end(chapter);
+  }
+private:
+  perf_counters_scope(const perf_counters_scope &);
+  perf_counters_scope &operator=(const perf_counters_scope &);
+  int chapter;
+};
+
+/* call once per frame, after every chapter of the frame was drawn */
+void
+perf_counters_end_frame();
+
+/* print the summary, and close the counters */
+void
+perf_counters_shutdown();
+
+#endif
@@ -0,0 +1,699 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <thread>
+#include <vector>
+#include "main.h"
+#include "options.h"
+#include "matrix.h"
+#include "mesh_scene.h"
+#include "split_screen.h"
+#include "picking.h"
+
+typedef std::chrono::steady_clock picking_clock;
+
+struct picking_bounds {
+  GLfloat min[3], max[3];
+};
+
+// a node of a hierarchy: if "count" is 0, its children are nodes
+// "first" and "first" + 1; otherwise it is a leaf, of "count" items
+// starting at "first" in "items"
+struct hierarchy_node {
+  picking_bounds bounds;
+  uint32_t first;
+  uint32_t count;
+};
+
+// a ray, with what the box test needs precomputed
+struct traced_ray {
+  GLfloat origin[3];
+  GLfloat direction[3];
+  GLfloat inverse_direction[3];
+};
+
+static traced_ray
+traced(const GLfloat origin[3],
+       const GLfloat direction[3])
+{
+  traced_ray result;
+  for(int axis = 0; axis < 3; axis++){
+    result.origin[axis] = origin[axis];
+    result.direction[axis] = direction[axis];
+    result.inverse_direction[axis] = 1.0f / direction[axis];
+  }
+  return result;
+}
+
+// true if "ray" enters "box" before "nearest"; "entry" is where
+static bool
+ray_hits_box(const traced_ray &ray,
+             const picking_bounds &box,
+             GLfloat nearest,
+             GLfloat *entry)
+{
+  GLfloat t_min = 0.0f, t_max = nearest;
+  for(int axis = 0; axis < 3; axis++){
+    GLfloat t_0 = (box.min[axis] - ray.origin[axis]) * ray.inverse_direction[axis];
+    GLfloat t_1 = (box.max[axis] - ray.origin[axis]) * ray.inverse_direction[axis];
+    if(t_0 > t_1){
+      std::swap(t_0, t_1);
+    }
+    t_min = std::max(t_min, t_0);
+    t_max = std::min(t_max, t_1);
+    if(t_min > t_max){
+      return false;
+    }
+  }
+  *entry = t_min;
+  return true;
+}
+
+class bounding_volume_hierarchy {
+public:
+  std::vector<hierarchy_node> nodes;
+  std::vector<uint32_t> items;
+
+  void
+  build(const std::vector<picking_bounds> &item_bounds)
+  {
+    bounds = &item_bounds;
+    centers.resize(item_bounds.size());
+    items.resize(item_bounds.size());
+    for(size_t i = 0; i < item_bounds.size(); i++){
+      for(int axis = 0; axis < 3; axis++){
+        centers[i].min[axis] = centers[i].max[axis] =
+          0.5f * (item_bounds[i].min[axis] + item_bounds[i].max[axis]);
+      }
+      items[i] = (uint32_t) i;
+    }
+    nodes.clear();
+    if(items.empty()){
+      bounds = NULL;
+      return;
+    }
+    nodes.reserve(2 * items.size() + 1);
+    nodes.push_back(hierarchy_node());
+    build_node(0, 0, (uint32_t) items.size());
+    centers.clear();
+    bounds = NULL;
+  }
+
+  /* call "test(item, &nearest)" for each item whose leaf "ray" enters
+   * before "nearest"; "test" lowers "nearest" if it hits the item
+   */
+  template<typename F>
+  void
+  traverse(const traced_ray &ray,
+           GLfloat *nearest,
+           unsigned long *visited,
+           F test) const
+  {
+    if(nodes.empty() || items.empty()){
+      return;
+    }
+    struct pending {
+      uint32_t node;
+      GLfloat entry;
+    };
+    pending stack[64];
+    int top = 0;
+    GLfloat entry;
+    if(!ray_hits_box(ray, nodes[0].bounds, *nearest, &entry)){
+      return;
+    }
+    stack[top].node = 0;
+    stack[top++].entry = entry;
+    while(top > 0){
+      const pending p = stack[--top];
+      // the nearest hit may have moved closer since it was pushed
+      if(p.entry > *nearest){
+        continue;
+      }
+      const hierarchy_node &node = nodes[p.node];
+      (*visited)++;
+      if(node.count > 0){
+        for(uint32_t i = node.first; i < node.first + node.count; i++){
+          test(items[i], nearest);
+        }
+        continue;
+      }
+      GLfloat entry_a, entry_b;
+      const bool hit_a = ray_hits_box(ray, nodes[node.first].bounds, *nearest, &entry_a);
+      const bool hit_b = ray_hits_box(ray, nodes[node.first + 1].bounds, *nearest, &entry_b);
+      uint32_t near_child = node.first, far_child = node.first + 1;
+      if(hit_a && hit_b && entry_b < entry_a){
+        std::swap(near_child, far_child);
+        std::swap(entry_a, entry_b);
+      }
+      // the nearer child is popped first
+      if(hit_a && hit_b){
+        stack[top].node = far_child;
+        stack[top++].entry = entry_b;
+        stack[top].node = near_child;
+        stack[top++].entry = entry_a;
+      }
+      else if(hit_a){
+        stack[top].node = node.first;
+        stack[top++].entry = entry_a;
+      }
+      else if(hit_b){
+        stack[top].node = node.first + 1;
+        stack[top++].entry = entry_b;
+      }
+    }
+  }
+
+private:
+  const std::vector<picking_bounds> *bounds = NULL;
+  // the center of each item, as a box of no size
+  std::vector<picking_bounds> centers;
+
+  static void
+  enclose(picking_bounds *box,
+          const picking_bounds &other)
+  {
+    for(int axis = 0; axis < 3; axis++){
+      box->min[axis] = std::min(box->min[axis], other.min[axis]);
+      box->max[axis] = std::max(box->max[axis], other.max[axis]);
+    }
+  }
+
+  // split the items in half across the longest axis of their centers,
+  // until a few remain
+  void
+  build_node(uint32_t index,
+             uint32_t first,
+             uint32_t count)
+  {
+    picking_bounds box = (*bounds)[items[first]];
+    picking_bounds center_box = centers[items[first]];
+    for(uint32_t i = first + 1; i < first + count; i++){
+      enclose(&box, (*bounds)[items[i]]);
+      enclose(&center_box, centers[items[i]]);
+    }
+    nodes[index].bounds = box;
+    nodes[index].first = first;
+    nodes[index].count = count;
+    int axis = 0;
+    for(int a = 1; a < 3; a++){
+      if(center_box.max[a] - center_box.min[a] > center_box.max[axis] - center_box.min[axis]){
+        axis = a;
+      }
+    }
+    // depth is bounded by the stack of "traverse", since each split
+    // halves the items
+    if(count <= 4 || center_box.max[axis] == center_box.min[axis]){
+      return;
+    }
+    const uint32_t middle = first + count / 2;
+    const std::vector<picking_bounds> &c = centers;
+    std::nth_element(items.begin() + first,
+                     items.begin() + middle,
+                     items.begin() + first + count,
+                     [&](uint32_t a, uint32_t b){
+                       return c[a].min[axis] < c[b].min[axis];
+                     });
+    const uint32_t children = (uint32_t) nodes.size();
+    nodes.push_back(hierarchy_node());
+    nodes.push_back(hierarchy_node());
+    nodes[index].first = children;
+    nodes[index].count = 0;
+    build_node(children, first, middle - first);
+    build_node(children + 1, middle, first + count - middle);
+  }
+};
+
+static bool active = false;
+static GLFWwindow *picked_window = NULL;
+static const mesh_file *scene_file = NULL;
+// for each mesh of MVP_SCENE, over its triangles in model space
+static std::vector<bounding_volume_hierarchy> mesh_hierarchies;
+// over the objects of MVP_SCENE, in world space
+static bounding_volume_hierarchy object_hierarchy;
+static std::vector<Matrix4> object_inverses;
+
+// as of the last frame
+static bool have_scene = false;
+static bool scene_objects_included = false;
+static Matrix4 projection, camera;
+static Matrix4 quad_inverses[3];
+static int framebuffer_width = 0, framebuffer_height = 0;
+
+static int hovered = picking_nothing;
+
+// counters
+static unsigned long rays_cast = 0;
+static unsigned long nodes_visited = 0;
+static picking_clock::duration time_casting = picking_clock::duration::zero();
+static double build_milliseconds = 0.0;
+static unsigned long triangles = 0;
+
+bool
+picking_enabled()
+{
+  static const bool result = option_enabled("PICKING") && !regression_child();
+  return result;
+}
+
+// "matrix" times (x, y, z, w)
+static void
+transform(const Matrix4 &matrix,
+          const GLfloat in[3],
+          GLfloat w,
+          GLfloat out[3])
+{
+  for(int row = 0; row < 3; row++){
+    out[row] = matrix.at(row, 0) * in[0]
+      + matrix.at(row, 1) * in[1]
+      + matrix.at(row, 2) * in[2]
+      + matrix.at(row, 3) * w;
+  }
+}
+
+// where "ray" hits the triangle "a", "b", "c", by Moller and
+// Trumbore's method
+static bool
+ray_hits_triangle(const traced_ray &ray,
+                  const GLfloat *a,
+                  const GLfloat *b,
+                  const GLfloat *c,
+                  GLfloat *t)
+{
+  const GLfloat e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+  const GLfloat e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+  const GLfloat *d = ray.direction;
+  const GLfloat p[3] = {d[1] * e2[2] - d[2] * e2[1],
+                        d[2] * e2[0] - d[0] * e2[2],
+                        d[0] * e2[1] - d[1] * e2[0]};
+  const GLfloat determinant = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+  if(std::fabs(determinant) < 1e-12f){
+    return false;
+  }
+  const GLfloat inverse = 1.0f / determinant;
+  const GLfloat s[3] = {ray.origin[0] - a[0], ray.origin[1] - a[1], ray.origin[2] - a[2]};
+  const GLfloat u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverse;
+  if(u < 0.0f || u > 1.0f){
+    return false;
+  }
+  const GLfloat q[3] = {s[1] * e1[2] - s[2] * e1[1],
+                        s[2] * e1[0] - s[0] * e1[2],
+                        s[0] * e1[1] - s[1] * e1[0]};
+  const GLfloat v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inverse;
+  if(v < 0.0f || u + v > 1.0f){
+    return false;
+  }
+  *t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inverse;
+  return *t > 0.0f;
+}
+
+// the square from -1 to 1, in its model space, seen from either side
+static bool
+ray_hits_quad(const traced_ray &ray,
+              GLfloat *t)
+{
+  if(ray.direction[2] == 0.0f){
+    return false;
+  }
+  *t = -ray.origin[2] / ray.direction[2];
+  const GLfloat x = ray.origin[0] + *t * ray.direction[0];
+  const GLfloat y = ray.origin[1] + *t * ray.direction[1];
+  return *t > 0.0f && std::fabs(x) <= 1.0f && std::fabs(y) <= 1.0f;
+}
+
+static void
+build_scene_hierarchies()
+{
+  const picking_clock::time_point start = picking_clock::now();
+  const mesh_file &file = *scene_file;
+  mesh_hierarchies.resize(file.header->number_of_meshes);
+  std::vector<picking_bounds> item_bounds;
+  for(uint64_t m = 0; m < file.header->number_of_meshes; m++){
+    const mesh_file_mesh &mesh = file.meshes[m];
+    if(!mesh_file_indices_valid(file, mesh)){
+      // left empty, as a mesh which nothing hits; "mesh_scene_draw"
+      // reports it
+      continue;
+    }
+    const GLfloat *vertices = mesh_file_vertices(file, mesh);
+    const uint32_t *indices = mesh_file_indices(file, mesh);
+    item_bounds.resize(mesh.number_of_indices / 3);
+    for(size_t t = 0; t < item_bounds.size(); t++){
+      picking_bounds &box = item_bounds[t];
+      for(int axis = 0; axis < 3; axis++){
+        box.min[axis] = std::numeric_limits<GLfloat>::max();
+        box.max[axis] = -std::numeric_limits<GLfloat>::max();
+      }
+      for(int corner = 0; corner < 3; corner++){
+        const GLfloat *v = vertices + 3 * indices[3 * t + corner];
+        for(int axis = 0; axis < 3; axis++){
+          box.min[axis] = std::min(box.min[axis], v[axis]);
+          box.max[axis] = std::max(box.max[axis], v[axis]);
+        }
+      }
+    }
+    mesh_hierarchies[m].build(item_bounds);
+    triangles += item_bounds.size();
+  }
+
+  // each object's bounds are those of its mesh's bounds, placed in
+  // world space
+  const uint64_t number_of_objects = file.header->number_of_objects;
+  object_inverses.resize(number_of_objects);
+  item_bounds.resize(number_of_objects);
+  for(uint64_t o = 0; o < number_of_objects; o++){
+    const mesh_file_object &object = file.objects[o];
+    Matrix4 model;
+    std::copy(object.transform, object.transform + 16, model.m);
+    object_inverses[o] = model.inverse();
+    picking_bounds &box = item_bounds[o];
+    const bounding_volume_hierarchy &mesh = mesh_hierarchies[object.mesh];
+    if(mesh.nodes.empty() || mesh.items.empty()){
+      // a mesh of no triangles, which nothing hits
+      for(int axis = 0; axis < 3; axis++){
+        box.min[axis] = box.max[axis] = model.at(axis, 3);
+      }
+      continue;
+    }
+    const picking_bounds &local = mesh.nodes[0].bounds;
+    for(int axis = 0; axis < 3; axis++){
+      box.min[axis] = std::numeric_limits<GLfloat>::max();
+      box.max[axis] = -std::numeric_limits<GLfloat>::max();
+    }
+    for(int corner = 0; corner < 8; corner++){
+      const GLfloat p[3] = {(corner & 1) ? local.max[0] : local.min[0],
+                            (corner & 2) ? local.max[1] : local.min[1],
+                            (corner & 4) ? local.max[2] : local.min[2]};
+      GLfloat world[3];
+      transform(model, p, 1.0f, world);
+      for(int axis = 0; axis < 3; axis++){
+        box.min[axis] = std::min(box.min[axis], world[axis]);
+        box.max[axis] = std::max(box.max[axis], world[axis]);
+      }
+    }
+  }
+  object_hierarchy.build(item_bounds);
+  build_milliseconds =
+    std::chrono::duration<double, std::milli>(picking_clock::now() - start).count();
+}
+
+static picking_hit
+cast(const picking_ray &world_ray,
+     unsigned long *visited)
+{
+  picking_hit hit = {picking_nothing, 0.0f};
+  // along the ray, 0 at the near plane and 1 at the far plane
+  GLfloat nearest = std::numeric_limits<GLfloat>::max();
+
+  for(int q = 0; q < 3; q++){
+    GLfloat origin[3], direction[3], t;
+    transform(quad_inverses[q], world_ray.origin, 1.0f, origin);
+    transform(quad_inverses[q], world_ray.direction, 0.0f, direction);
+    if(ray_hits_quad(traced(origin, direction), &t) && t < nearest){
+      nearest = t;
+      hit.object = q;
+    }
+  }
+
+  if(scene_objects_included && scene_file){
+    const mesh_file &file = *scene_file;
+    const traced_ray ray = traced(world_ray.origin, world_ray.direction);
+    object_hierarchy.traverse(ray, &nearest, visited, [&](uint32_t o, GLfloat *nearest_so_far){
+        const mesh_file_object &object = file.objects[o];
+        const mesh_file_mesh &mesh = file.meshes[object.mesh];
+        const GLfloat *vertices = mesh_file_vertices(file, mesh);
+        const uint32_t *indices = mesh_file_indices(file, mesh);
+        // the same ray in the object's model space; since the direction
+        // is not normalized, distances along it are unchanged
+        GLfloat origin[3], direction[3];
+        transform(object_inverses[o], world_ray.origin, 1.0f, origin);
+        transform(object_inverses[o], world_ray.direction, 0.0f, direction);
+        const traced_ray local = traced(origin, direction);
+        mesh_hierarchies[object.mesh].traverse(local,
+                                               nearest_so_far,
+                                               visited,
+                                               [&](uint32_t triangle, GLfloat *nearest_in_mesh){
+            GLfloat t;
+            if(ray_hits_triangle(local,
+                                 vertices + 3 * indices[3 * triangle],
+                                 vertices + 3 * indices[3 * triangle + 1],
+                                 vertices + 3 * indices[3 * triangle + 2],
+                                 &t)
+               && t < *nearest_in_mesh){
+              *nearest_in_mesh = t;
+              hit.object = picking_first_scene_object + (int) o;
+            }
+          });
+      });
+  }
+
+  if(hit.object != picking_nothing){
+    const GLfloat *d = world_ray.direction;
+    hit.distance = nearest * std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+  }
+  return hit;
+}
+
+picking_hit
+picking_cast(const picking_ray &ray)
+{
+  const picking_clock::time_point start = picking_clock::now();
+  const picking_hit hit = cast(ray, &nodes_visited);
+  time_casting += picking_clock::now() - start;
+  rays_cast++;
+  return hit;
+}
+
+void
+picking_cast_many(const std::vector<picking_ray> &rays,
+                  std::vector<picking_hit> *hits)
+{
+  const picking_clock::time_point start = picking_clock::now();
+  hits->resize(rays.size());
+  // below this, starting threads costs more than it saves
+  static const size_t rays_per_thread = 4096;
+  size_t threads = std::min((size_t) std::max(1u, std::thread::hardware_concurrency()),
+                            (rays.size() + rays_per_thread - 1) / rays_per_thread);
+  if(threads < 1){
+    threads = 1;
+  }
+  std::vector<unsigned long> visited(threads, 0);
+  auto work = [&](size_t thread){
+    const size_t first = rays.size() * thread / threads;
+    const size_t last = rays.size() * (thread + 1) / threads;
+    for(size_t r = first; r < last; r++){
+      (*hits)[r] = cast(rays[r], &visited[thread]);
+    }
+  };
+  std::vector<std::thread> workers;
+  for(size_t t = 1; t < threads; t++){
+    workers.push_back(std::thread(work, t));
+  }
+  work(0);
+  for(size_t t = 0; t < workers.size(); t++){
+    workers[t].join();
+  }
+  for(size_t t = 0; t < threads; t++){
+    nodes_visited += visited[t];
+  }
+  time_casting += picking_clock::now() - start;
+  rays_cast += rays.size();
+}
+
+picking_ray
+picking_ray_through(const Matrix4 &projection,
+                    const Matrix4 &camera,
+                    GLfloat x,
+                    GLfloat y,
+                    int width,
+                    int height)
+{
+  // the pixel's center in NDC, on the near plane and on the far plane,
+  // taken back into world space
+  const Matrix4 to_world = projection.multiply(camera).inverse();
+  const GLfloat ndc_x = 2.0f * (x + 0.5f) / (GLfloat) width - 1.0f;
+  const GLfloat ndc_y = 1.0f - 2.0f * (y + 0.5f) / (GLfloat) height;
+  GLfloat ends[2][3];
+  for(int e = 0; e < 2; e++){
+    const GLfloat clip[4] = {ndc_x, ndc_y, e == 0 ? -1.0f : 1.0f, 1.0f};
+    GLfloat world[4];
+    for(int row = 0; row < 4; row++){
+      world[row] = to_world.at(row, 0) * clip[0]
+        + to_world.at(row, 1) * clip[1]
+        + to_world.at(row, 2) * clip[2]
+        + to_world.at(row, 3) * clip[3];
+    }
+    for(int axis = 0; axis < 3; axis++){
+      ends[e][axis] = world[axis] / world[3];
+    }
+  }
+  picking_ray ray;
+  for(int axis = 0; axis < 3; axis++){
+    ray.origin[axis] = ends[0][axis];
+    ray.direction[axis] = ends[1][axis] - ends[0][axis];
+  }
+  return ray;
+}
+
+void
+picking_set_scene(const core_profile_scene &scene,
+                  bool with_mesh_scene)
+{
+  if(!active){
+    return;
+  }
+  projection = core_profile_projection(scene);
+  camera = core_profile_camera(scene);
+  Matrix4 models[3];
+  core_profile_models(scene, models);
+  for(int q = 0; q < 3; q++){
+    quad_inverses[q] = models[q].inverse();
+  }
+  framebuffer_width = scene.framebuffer_width;
+  framebuffer_height = scene.framebuffer_height;
+  scene_objects_included = with_mesh_scene;
+  have_scene = true;
+}
+
+static void
+describe(const char *what,
+         const picking_hit &hit)
+{
+  if(hit.object == picking_nothing){
+    fprintf(stderr, "%s nothing\n", what);
+    return;
+  }
+  static const char *names[] = {"paddle 1", "the square", "paddle 2"};
+  if(hit.object < picking_first_scene_object){
+    fprintf(stderr, "%s %s, %.1f away\n", what, names[hit.object], hit.distance);
+  }
+  else{
+    fprintf(stderr, "%s scene object %d, %.1f away\n",
+            what,
+            hit.object - picking_first_scene_object,
+            hit.distance);
+  }
+}
+
+// the cursor's position, in the framebuffer's pixels
+static void
+cursor_in_framebuffer(double x,
+                      double y,
+                      GLfloat *fb_x,
+                      GLfloat *fb_y)
+{
+  int window_width, window_height;
+  glfwGetWindowSize(picked_window, &window_width, &window_height);
+  *fb_x = (GLfloat) (x * framebuffer_width / (window_width > 0 ? window_width : 1));
+  *fb_y = (GLfloat) (y * framebuffer_height / (window_height > 0 ? window_height : 1));
+}
+
+static void
+mouse_button_callback(GLFWwindow *window,
+                      int button,
+                      int action,
+                      int mods)
+{
+  if(!have_scene || button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS){
+    return;
+  }
+  double x, y;
+  glfwGetCursorPos(window, &x, &y);
+  GLfloat fb_x, fb_y;
+  cursor_in_framebuffer(x, y, &fb_x, &fb_y);
+  describe("picked",
+           picking_cast(picking_ray_through(projection,
+                                            camera,
+                                            fb_x,
+                                            fb_y,
+                                            framebuffer_width,
+                                            framebuffer_height)));
+}
+
+static void
+cursor_position_callback(GLFWwindow *window,
+                         double x,
+                         double y)
+{
+  if(!have_scene){
+    return;
+  }
+  GLfloat fb_x, fb_y;
+  cursor_in_framebuffer(x, y, &fb_x, &fb_y);
+  static const int radius = std::max(0, option_int("PICK_RADIUS", 2));
+  static std::vector<picking_ray> rays;
+  static std::vector<picking_hit> hits;
+  rays.clear();
+  for(int dy = -radius; dy <= radius; dy++){
+    for(int dx = -radius; dx <= radius; dx++){
+      rays.push_back(picking_ray_through(projection,
+                                         camera,
+                                         fb_x + dx,
+                                         fb_y + dy,
+                                         framebuffer_width,
+                                         framebuffer_height));
+    }
+  }
+  picking_cast_many(rays, &hits);
+  picking_hit nearest = {picking_nothing, 0.0f};
+  for(size_t h = 0; h < hits.size(); h++){
+    if(hits[h].object != picking_nothing
+       && (nearest.object == picking_nothing || hits[h].distance < nearest.distance)){
+      nearest = hits[h];
+    }
+  }
+  if(nearest.object != hovered){
+    hovered = nearest.object;
+    describe("hovering over", nearest);
+  }
+}
+
+void
+picking_init(GLFWwindow *window)
+{
+  if(!picking_enabled()){
+    return;
+  }
+  if(split_screen_active()){
+    fprintf(stderr, "Picking is unavailable with a split screen, ignoring MVP_PICKING\n");
+    return;
+  }
+  picked_window = window;
+  scene_file = mesh_scene_file();
+  if(scene_file){
+    build_scene_hierarchies();
+  }
+  glfwSetMouseButtonCallback(window, mouse_button_callback);
+  glfwSetCursorPosCallback(window, cursor_position_callback);
+  active = true;
+}
+
+void
+picking_report()
+{
+  if(scene_file){
+    fprintf(stderr,
+            "picking: hierarchies over %llu objects and %lu triangles built in %.1f ms\n",
+            (unsigned long long) scene_file->header->number_of_objects,
+            triangles,
+            build_milliseconds);
+  }
+  if(rays_cast == 0){
+    return;
+  }
+  fprintf(stderr,
+          "picking: %lu rays, %.2f us and %.1f nodes visited per ray\n",
+          rays_cast,
+          std::chrono::duration<double, std::micro>(time_casting).count() / rays_cast,
+          (double) nodes_visited / rays_cast);
+}
@@ -0,0 +1,104 @@
+#ifndef PICKING_H
+#define PICKING_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <vector>
+#include "core_profile.h"
+
+/* Picking objects with the mouse, in chapters 16 and 17.
+ *
+ * A position in the window is turned into a ray by the inverse of the
+ * projection and camera (see "core_profile.h"): the points on the
+ * near and far planes under the pixel, in NDC, are taken back into
+ * world space.  The ray is then intersected with every object, and
+ * the nearest one hit is returned.
+ *
+ * The objects of MVP_SCENE (see "mesh_scene.h") are many triangles
+ * each, so testing each one would be slow.  Instead, a bounding volume
+ * hierarchy is built once, for each mesh, over its triangles in model
+ * space, and another over the objects' bounds in world space.  A ray
+ * descends only into the boxes it passes through, nearest first, and
+ * stops at boxes farther than the nearest hit so far; an object's
+ * mesh is searched with the ray moved into the object's model space.
+ * The paddles and the square move every frame, and are only three
+ * quads, so they are tested directly.
+ *
+ * If MVP_PICKING=1 is set, clicking the left mouse button prints the
+ * object under the cursor to stderr, and so does moving the cursor
+ * onto a different object.  Both are answered as the mouse's events
+ * arrive, against the scene of the last frame, which is the one on
+ * the screen.  Hovering casts a batch of rays, across
+ * MVP_PICK_RADIUS pixels (default 2) about the cursor, so that thin
+ * objects are easy to find.  Batches of many rays are divided among
+ * threads.  The number of rays cast, and their average cost, are
+ * printed at exit.  Not available with a split screen.
+ */
+
+/* objects 0, 1 and 2 are paddle 1, the square, and paddle 2; the
+ * objects of MVP_SCENE follow
+ */
+enum {
+  picking_nothing = -1,
+  picking_paddle_1 = 0,
+  picking_square = 1,
+  picking_paddle_2 = 2,
+  picking_first_scene_object = 3
+};
+
+struct picking_ray {
+  GLfloat origin[3];
+  // from the near plane to the far plane
+  GLfloat direction[3];
+};
+
+struct picking_hit {
+  int object;
+  // along the ray, in world-space units
+  GLfloat distance;
+};
+
+bool
+picking_enabled();
+
+/* install the mouse callbacks, and build the hierarchy of the objects
+ * of MVP_SCENE, if any
+ */
+void
+picking_init(GLFWwindow *window);
+
+/* the ray through the center of pixel "x", "y" of the framebuffer,
+ * counted from the top left
+ */
+picking_ray
+picking_ray_through(const Matrix4 &projection,
+                    const Matrix4 &camera,
+                    GLfloat x,
+                    GLfloat y,
+                    int width,
+                    int height);
+
+/* call once per frame of chapters 16 and 17: place the paddles and
+ * the square, and the camera, for the following casts, and say
+ * whether the objects of MVP_SCENE are in the scene
+ */
+void
+picking_set_scene(const core_profile_scene &scene,
+                  bool with_mesh_scene);
+
+picking_hit
+picking_cast(const picking_ray &ray);
+
+/* "hits[i]" for "rays[i]" */
+void
+picking_cast_many(const std::vector<picking_ray> &rays,
+                  std::vector<picking_hit> *hits);
+
+void
+picking_report();
+
+#endif
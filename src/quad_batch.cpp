@@ -0,0 +1,343 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#define QUAD_BATCH_IMPLEMENTATION 1
+#include "main.h"
+#include "options.h"
+#include "mesh_file.h"
+#include "mesh_optimize.h"
+
+// one recorded vertex, interleaved for "glVertexPointer"/"glColorPointer"
+struct batched_vertex {
+  GLfloat x, y, z;
+  GLfloat red, green, blue;
+};
+
+struct batched_vertex_hash {
+  size_t operator()(const batched_vertex &v) const
+  {
+    uint32_t bits[6];
+    memcpy(bits, &v, sizeof(bits));
+    uint64_t hash = 14695981039346656037ULL;
+    for(int i = 0; i < 6; i++){
+      hash = (hash ^ bits[i]) * 1099511628211ULL;
+    }
+    return (size_t) (hash ^ (hash >> 32));
+  }
+};
+
+struct batched_vertex_equal {
+  bool operator()(const batched_vertex &a,
+                  const batched_vertex &b) const
+  {
+    return memcmp(&a, &b, sizeof(batched_vertex)) == 0;
+  }
+};
+
+static std::vector<batched_vertex> vertices;
+// what is submitted: each distinct vertex once, and triangles of indices
+static std::vector<batched_vertex> unique_vertices;
+static std::vector<uint32_t> indices;
+static std::unordered_map<batched_vertex, uint32_t,
+                          batched_vertex_hash, batched_vertex_equal> welded;
+static GLfloat current_color[3] = {1.0f, 1.0f, 1.0f};
+// true between "glBegin(GL_QUADS)" and "glEnd"
+static bool recording = false;
+// where the quad currently being specified begins in "vertices"
+static size_t primitive_start = 0;
+
+// counters
+static unsigned long quads = 0;
+static unsigned long submitted_vertices = 0;
+static unsigned long draw_calls = 0;
+static unsigned long frames = 0;
+
+bool
+quad_batch_enabled()
+{
+  static const bool result = option_enabled("BATCH");
+  return result;
+}
+
+void
+quad_batch_flush()
+{
+  if(vertices.empty()){
+    return;
+  }
+  // corners which adjacent quads share are sent, and transformed, once
+  unique_vertices.clear();
+  indices.clear();
+  welded.clear();
+  for(size_t v = 0; v < vertices.size(); v++){
+    std::pair<std::unordered_map<batched_vertex, uint32_t,
+                                 batched_vertex_hash, batched_vertex_equal>::iterator,
+              bool> inserted =
+      welded.insert(std::make_pair(vertices[v], (uint32_t) unique_vertices.size()));
+    if(inserted.second){
+      unique_vertices.push_back(vertices[v]);
+    }
+    indices.push_back(inserted.first->second);
+  }
+  mesh_quads_to_triangles(&indices);
+
+  // keep the client arrays of anyone else, e.g. the stream buffer
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glVertexPointer(/*size*/ 3,
+                  GL_FLOAT,
+                  /*stride*/ sizeof(batched_vertex),
+                  &unique_vertices[0].x);
+  glColorPointer(/*size*/ 3,
+                 GL_FLOAT,
+                 /*stride*/ sizeof(batched_vertex),
+                 &unique_vertices[0].red);
+  glDrawElements(GL_TRIANGLES,
+                 /*count*/ (GLsizei) indices.size(),
+                 GL_UNSIGNED_INT,
+                 &indices[0]);
+  glPopClientAttrib();
+  draw_calls++;
+  quads += vertices.size() / 4;
+  submitted_vertices += unique_vertices.size();
+  vertices.clear();
+  // drawing with a color array leaves the current color undefined
+  gl_state_cache_forget_color();
+  glColor3f(current_color[0], current_color[1], current_color[2]);
+}
+
+void
+quad_batch_glBegin(GLenum mode)
+{
+  if(quad_batch_enabled() && mode == GL_QUADS){
+    recording = true;
+    primitive_start = vertices.size();
+    return;
+  }
+  quad_batch_flush();
+  glBegin(mode);
+}
+
+void
+quad_batch_glEnd()
+{
+  if(!recording){
+    glEnd();
+    return;
+  }
+  // as OpenGL does, drop the vertices of an incomplete quad
+  vertices.resize(vertices.size() - (vertices.size() - primitive_start) % 4);
+  recording = false;
+}
+
+void
+quad_batch_glVertex3f(GLfloat x,
+                      GLfloat y,
+                      GLfloat z)
+{
+  if(!recording){
+    glVertex3f(x, y, z);
+    return;
+  }
+  batched_vertex v = {x, y, z,
+                      current_color[0], current_color[1], current_color[2]};
+  vertices.push_back(v);
+}
+
+void
+quad_batch_glVertex2f(GLfloat x,
+                      GLfloat y)
+{
+  if(!recording){
+    glVertex2f(x, y);
+    return;
+  }
+  quad_batch_glVertex3f(x, y, 0.0f);
+}
+
+void
+quad_batch_glColor3f(GLfloat red,
+                     GLfloat green,
+                     GLfloat blue)
+{
+  current_color[0] = red;
+  current_color[1] = green;
+  current_color[2] = blue;
+  // a color set outside of "glBegin" is also the color of later
+  // immediate-mode drawing, so it must reach OpenGL
+  if(!recording){
+    glColor3f(red, green, blue);
+  }
+}
+
+void
+quad_batch_glClear(GLbitfield mask)
+{
+  quad_batch_flush();
+  glClear(mask);
+}
+
+void
+quad_batch_glViewport(GLint x,
+                      GLint y,
+                      GLsizei width,
+                      GLsizei height)
+{
+  quad_batch_flush();
+  glViewport(x, y, width, height);
+}
+
+void
+quad_batch_glScissor(GLint x,
+                     GLint y,
+                     GLsizei width,
+                     GLsizei height)
+{
+  quad_batch_flush();
+  glScissor(x, y, width, height);
+}
+
+void
+quad_batch_glEnable(GLenum cap)
+{
+  quad_batch_flush();
+  glEnable(cap);
+}
+
+void
+quad_batch_glDisable(GLenum cap)
+{
+  quad_batch_flush();
+  glDisable(cap);
+}
+
+void
+quad_batch_glDepthFunc(GLenum func)
+{
+  quad_batch_flush();
+  glDepthFunc(func);
+}
+
+void
+quad_batch_glBlendFunc(GLenum sfactor,
+                       GLenum dfactor)
+{
+  quad_batch_flush();
+  glBlendFunc(sfactor, dfactor);
+}
+
+void
+quad_batch_glLoadIdentity()
+{
+  quad_batch_flush();
+  glLoadIdentity();
+}
+
+void
+quad_batch_glPushMatrix()
+{
+  quad_batch_flush();
+  glPushMatrix();
+}
+
+void
+quad_batch_glPopMatrix()
+{
+  quad_batch_flush();
+  glPopMatrix();
+}
+
+void
+quad_batch_glTranslatef(GLfloat x,
+                        GLfloat y,
+                        GLfloat z)
+{
+  quad_batch_flush();
+  glTranslatef(x, y, z);
+}
+
+void
+quad_batch_glRotatef(GLfloat angle,
+                     GLfloat x,
+                     GLfloat y,
+                     GLfloat z)
+{
+  quad_batch_flush();
+  glRotatef(angle, x, y, z);
+}
+
+void
+quad_batch_glScalef(GLfloat x,
+                    GLfloat y,
+                    GLfloat z)
+{
+  quad_batch_flush();
+  glScalef(x, y, z);
+}
+
+void
+quad_batch_glDrawArrays(GLenum mode,
+                        GLint first,
+                        GLsizei count)
+{
+  quad_batch_flush();
+  glDrawArrays(mode, first, count);
+}
+
+void
+quad_batch_glMultMatrixf(const GLfloat *m)
+{
+  quad_batch_flush();
+  glMultMatrixf(m);
+}
+
+void
+quad_batch_glDrawElements(GLenum mode,
+                          GLsizei count,
+                          GLenum type,
+                          const GLvoid *indices)
+{
+  quad_batch_flush();
+  glDrawElements(mode, count, type, indices);
+}
+
+void
+quad_batch_gluPerspective(GLdouble fovy,
+                          GLdouble aspect,
+                          GLdouble z_near,
+                          GLdouble z_far)
+{
+  quad_batch_flush();
+  gluPerspective(fovy, aspect, z_near, z_far);
+}
+
+void
+quad_batch_end_frame()
+{
+  quad_batch_flush();
+  frames++;
+}
+
+void
+quad_batch_report()
+{
+  if(!quad_batch_enabled() || frames == 0){
+    return;
+  }
+  fprintf(stderr,
+          "quad batch: %lu frames, %.1f quads in %.1f draw calls, %.1f of %.1f vertices submitted, per frame\n",
+          frames,
+          (double) quads / frames,
+          (double) draw_calls / frames,
+          (double) submitted_vertices / frames,
+          (double) quads * 4 / frames);
+}
@@ -0,0 +1,152 @@
+#ifndef QUAD_BATCH_H
+#define QUAD_BATCH_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Batching of immediate-mode quadrilaterals.
+ *
+ * Each object in chapters 10 through 17 is drawn by its own
+ * "glBegin(GL_QUADS)" ... "glEnd" block, preceded by a "glColor3f".
+ * Every such block is a separate draw call.
+ *
+ * If MVP_BATCH=1 is set, the macros at the end of this file record
+ * those vertices, with their colors, into one vertex stream instead,
+ * and submit the stream as indexed triangles, with each distinct
+ * vertex sent once, by a single "glDrawElements" only when the
+ * render state is about to change: before a clear, a change of
+ * viewport, scissor, capability, depth or blend function, a change to
+ * the modelview or projection matrix, or another draw call.  Quads
+ * which share all of that state are therefore drawn together, and the
+ * order in which the pixels are written is unchanged.
+ *
+ * This is the topmost layer over the driver; the split screen, the
+ * state cache and the call tracer sit below it.  The number of quads
+ * and draw calls is printed at exit.
+ */
+
+bool
+quad_batch_enabled();
+
+void
+quad_batch_glBegin(GLenum mode);
+void
+quad_batch_glEnd();
+void
+quad_batch_glVertex2f(GLfloat x,
+                      GLfloat y);
+void
+quad_batch_glVertex3f(GLfloat x,
+                      GLfloat y,
+                      GLfloat z);
+void
+quad_batch_glColor3f(GLfloat red,
+                     GLfloat green,
+                     GLfloat blue);
+
+/* procedures which change the render state.  Each submits the
+ * quads recorded so far, then forwards the call.
+ */
+void
+quad_batch_glClear(GLbitfield mask);
+void
+quad_batch_glViewport(GLint x,
+                      GLint y,
+                      GLsizei width,
+                      GLsizei height);
+void
+quad_batch_glScissor(GLint x,
+                     GLint y,
+                     GLsizei width,
+                     GLsizei height);
+void
+quad_batch_glEnable(GLenum cap);
+void
+quad_batch_glDisable(GLenum cap);
+void
+quad_batch_glDepthFunc(GLenum func);
+void
+quad_batch_glBlendFunc(GLenum sfactor,
+                       GLenum dfactor);
+void
+quad_batch_glLoadIdentity();
+void
+quad_batch_glPushMatrix();
+void
+quad_batch_glPopMatrix();
+void
+quad_batch_glTranslatef(GLfloat x,
+                        GLfloat y,
+                        GLfloat z);
+void
+quad_batch_glRotatef(GLfloat angle,
+                     GLfloat x,
+                     GLfloat y,
+                     GLfloat z);
+void
+quad_batch_glScalef(GLfloat x,
+                    GLfloat y,
+                    GLfloat z);
+void
+quad_batch_glDrawArrays(GLenum mode,
+                        GLint first,
+                        GLsizei count);
+void
+quad_batch_glMultMatrixf(const GLfloat *m);
+void
+quad_batch_glDrawElements(GLenum mode,
+                          GLsizei count,
+                          GLenum type,
+                          const GLvoid *indices);
+void
+quad_batch_gluPerspective(GLdouble fovy,
+                          GLdouble aspect,
+                          GLdouble z_near,
+                          GLdouble z_far);
+
+/* submit the quads recorded so far */
+void
+quad_batch_flush();
+
+/* call after the last OpenGL call of each frame, before any other layer's */
+void
+quad_batch_end_frame();
+
+void
+quad_batch_report();
+
+#ifndef QUAD_BATCH_IMPLEMENTATION
+#define glBegin(mode) quad_batch_glBegin(mode)
+#define glEnd() quad_batch_glEnd()
+#define glVertex2f(x, y) quad_batch_glVertex2f(x, y)
+#define glVertex3f(x, y, z) quad_batch_glVertex3f(x, y, z)
+#define glColor3f(red, green, blue) quad_batch_glColor3f(red, green, blue)
+#define glClear(mask) quad_batch_glClear(mask)
+#define glViewport(x, y, width, height) \
+  quad_batch_glViewport(x, y, width, height)
+#define glScissor(x, y, width, height) \
+  quad_batch_glScissor(x, y, width, height)
+#define glEnable(cap) quad_batch_glEnable(cap)
+#define glDisable(cap) quad_batch_glDisable(cap)
+#define glDepthFunc(func) quad_batch_glDepthFunc(func)
+#define glBlendFunc(sfactor, dfactor) quad_batch_glBlendFunc(sfactor, dfactor)
+#define glLoadIdentity() quad_batch_glLoadIdentity()
+#define glPushMatrix() quad_batch_glPushMatrix()
+#define glPopMatrix() quad_batch_glPopMatrix()
+#define glTranslatef(x, y, z) quad_batch_glTranslatef(x, y, z)
+#define glRotatef(angle, x, y, z) quad_batch_glRotatef(angle, x, y, z)
+#define glScalef(x, y, z) quad_batch_glScalef(x, y, z)
+#define glDrawArrays(mode, first, count) \
+  quad_batch_glDrawArrays(mode, first, count)
+#define glMultMatrixf(m) quad_batch_glMultMatrixf(m)
+#define glDrawElements(mode, count, type, indices) \
+  quad_batch_glDrawElements(mode, count, type, indices)
+#define gluPerspective(fovy, aspect, z_near, z_far) \
+  quad_batch_gluPerspective(fovy, aspect, z_near, z_far)
+#endif
+
+#endif
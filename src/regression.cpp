@@ -0,0 +1,315 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#ifndef _WINDOWS
+#include <sys/wait.h>
+#endif
+#define SPLIT_SCREEN_IMPLEMENTATION 1
+#define REGRESSION_IMPLEMENTATION 1
+#include "main.h"
+#include "options.h"
+
+typedef std::chrono::steady_clock regression_clock;
+
+// frames rendered before the time between frames is recorded
+static const int warmup_frames = 10;
+
+// the input script: each key is held down, in turn, for this many frames
+static const int frames_per_key = 6;
+static const int script[] = {
+  GLFW_KEY_W,
+  GLFW_KEY_K,
+  GLFW_KEY_A,
+  GLFW_KEY_L,
+  GLFW_KEY_Q,
+  GLFW_KEY_E,
+  GLFW_KEY_UP,
+  GLFW_KEY_LEFT,
+  GLFW_KEY_PAGE_UP,
+  GLFW_KEY_RIGHT,
+  GLFW_KEY_D
+};
+static const int script_length = sizeof(script) / sizeof(script[0]);
+
+static int frame = 0;
+static regression_clock::time_point previous_frame_end;
+static std::vector<float> frame_times; // milliseconds
+static int exit_status = 0;
+
+bool
+regression_requested()
+{
+  return option_string("REGRESSION", NULL) != NULL;
+}
+
+bool
+regression_child()
+{
+  static const bool result = regression_requested()
+    && option_enabled("REGRESSION_CHILD");
+  return result;
+}
+
+static void
+set_environment(const char *name,
+                const char *value)
+{
+#ifdef _WINDOWS
+  _putenv_s(name, value);
+#else
+  setenv(name, value, /*overwrite*/ 1);
+#endif
+}
+
+int
+regression_run_all(const char *program)
+{
+  // the options given on the command line, for each child; the
+  // chapter is replaced by the child's own
+  options_to_environment();
+  set_environment("MVP_REGRESSION_CHILD", "1");
+  if(option_string("VSYNC", NULL) == NULL){
+    set_environment("MVP_VSYNC", "off");
+  }
+  int failures = 0;
+  for(int chapter = 2; chapter <= 17; chapter++){
+    // the chapter is given as an argument, so that nothing is asked
+    const std::string command =
+      std::string("\"") + program + "\" " + std::to_string(chapter);
+    const int wait_status = std::system(command.c_str());
+    if(wait_status == -1){
+      fprintf(stderr, "Error: could not run %s\n", program);
+      return 1;
+    }
+#ifdef _WINDOWS
+    const int status = wait_status;
+#else
+    const int status = WIFEXITED(wait_status) ? WEXITSTATUS(wait_status) : 1;
+#endif
+    if(status != 0){
+      failures++;
+    }
+  }
+  fprintf(stderr, "regression: %d of 16 chapters failed\n", failures);
+  return failures == 0 ? 0 : 1;
+}
+
+void
+regression_begin_frame()
+{
+  if(frame == 0){
+    previous_frame_end = regression_clock::now();
+  }
+}
+
+static std::string
+image_path(int chapter_number,
+           const char *suffix)
+{
+  char name[32];
+  snprintf(name, sizeof(name), "/chapter%02d%s.ppm", chapter_number, suffix);
+  return std::string(option_string("REGRESSION", ".")) + name;
+}
+
+// rows are stored top first, as in the file
+static bool
+write_ppm(const std::string &path,
+          int width,
+          int height,
+          const std::vector<unsigned char> &pixels)
+{
+  FILE *file = fopen(path.c_str(), "wb");
+  if(file == NULL){
+    fprintf(stderr, "Error: could not write %s\n", path.c_str());
+    return false;
+  }
+  fprintf(file, "P6\n%d %d\n255\n", width, height);
+  fwrite(&pixels[0], 1, pixels.size(), file);
+  fclose(file);
+  return true;
+}
+
+static bool
+read_ppm(const std::string &path,
+         int *width,
+         int *height,
+         std::vector<unsigned char> *pixels)
+{
+  FILE *file = fopen(path.c_str(), "rb");
+  if(file == NULL){
+    return false;
+  }
+  int max_value = 0;
+  bool ok = fscanf(file, "P6 %d %d %d", width, height, &max_value) == 3
+    && max_value == 255
+    && *width > 0
+    && *height > 0;
+  if(ok){
+    fgetc(file); // the single whitespace after the header
+    pixels->resize((size_t) *width * *height * 3);
+    ok = fread(&(*pixels)[0], 1, pixels->size(), file) == pixels->size();
+  }
+  fclose(file);
+  return ok;
+}
+
+static std::vector<unsigned char>
+read_framebuffer(int width,
+                 int height)
+{
+  std::vector<unsigned char> bottom_up((size_t) width * height * 3);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadBuffer(GL_BACK);
+  glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &bottom_up[0]);
+  std::vector<unsigned char> top_down(bottom_up.size());
+  const size_t row = (size_t) width * 3;
+  for(int y = 0; y < height; y++){
+    std::copy(bottom_up.begin() + (height - 1 - y) * row,
+              bottom_up.begin() + (height - y) * row,
+              top_down.begin() + y * row);
+  }
+  return top_down;
+}
+
+static void
+check_image(int chapter_number)
+{
+  int width = 0, height = 0;
+  glfwGetFramebufferSize(window, &width, &height);
+  const std::vector<unsigned char> actual = read_framebuffer(width, height);
+  const std::string golden_path = image_path(chapter_number, "");
+  if(option_enabled("REGRESSION_UPDATE")){
+    if(!write_ppm(golden_path, width, height, actual)){
+      exit_status = 1;
+    }
+    fprintf(stderr, "chapter %2d: wrote %s\n", chapter_number, golden_path.c_str());
+    return;
+  }
+  int golden_width = 0, golden_height = 0;
+  std::vector<unsigned char> golden;
+  if(!read_ppm(golden_path, &golden_width, &golden_height, &golden)){
+    fprintf(stderr, "chapter %2d: FAILED, could not read %s\n",
+            chapter_number, golden_path.c_str());
+    exit_status = 1;
+    return;
+  }
+  if(golden_width != width || golden_height != height){
+    fprintf(stderr, "chapter %2d: FAILED, %dx%d framebuffer, %dx%d golden image\n",
+            chapter_number, width, height, golden_width, golden_height);
+    write_ppm(image_path(chapter_number, ".actual"), width, height, actual);
+    exit_status = 1;
+    return;
+  }
+  const int tolerance = option_int("REGRESSION_TOLERANCE", 2);
+  int largest_difference = 0;
+  unsigned long pixels_differing = 0;
+  for(size_t pixel = 0; pixel < actual.size(); pixel += 3){
+    int difference = 0;
+    for(int channel = 0; channel < 3; channel++){
+      difference = std::max(difference,
+                            std::abs(actual[pixel + channel]
+                                     - golden[pixel + channel]));
+    }
+    largest_difference = std::max(largest_difference, difference);
+    if(difference > tolerance){
+      pixels_differing++;
+    }
+  }
+  if(pixels_differing > 0){
+    write_ppm(image_path(chapter_number, ".actual"), width, height, actual);
+    exit_status = 1;
+  }
+  fprintf(stderr, "chapter %2d: %s, %lu pixels beyond tolerance, largest difference %d\n",
+          chapter_number,
+          pixels_differing > 0 ? "FAILED" : "ok",
+          pixels_differing,
+          largest_difference);
+}
+
+static void
+record_frame_times(int chapter_number)
+{
+  if(frame_times.empty()){
+    return;
+  }
+  std::vector<float> sorted(frame_times);
+  std::sort(sorted.begin(), sorted.end());
+  double sum = 0.0;
+  for(size_t i = 0; i < sorted.size(); i++){
+    sum += sorted[i];
+  }
+  const size_t n = sorted.size();
+  const double mean = sum / n;
+  const float p50 = sorted[(n - 1) / 2];
+  const float p99 = sorted[(size_t) ((n - 1) * 0.99)];
+  fprintf(stderr,
+          "chapter %2d: %lu frames, mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+          chapter_number, (unsigned long) n, mean, p50, p99, sorted.back());
+
+  const std::string path = std::string(option_string("REGRESSION", "."))
+    + "/frame_times.csv";
+  FILE *existing = fopen(path.c_str(), "r");
+  const bool new_file = existing == NULL;
+  if(existing != NULL){
+    fclose(existing);
+  }
+  FILE *file = fopen(path.c_str(), "a");
+  if(file == NULL){
+    fprintf(stderr, "Error: could not write %s\n", path.c_str());
+    return;
+  }
+  if(new_file){
+    fprintf(file, "chapter,frames,mean_ms,p50_ms,p99_ms,max_ms\n");
+  }
+  fprintf(file, "%d,%lu,%.4f,%.4f,%.4f,%.4f\n",
+          chapter_number, (unsigned long) n, mean, p50, p99, sorted.back());
+  fclose(file);
+}
+
+bool
+regression_end_frame(int chapter_number)
+{
+  if(!regression_child()){
+    return false;
+  }
+  const regression_clock::time_point now = regression_clock::now();
+  if(frame >= warmup_frames){
+    frame_times.push_back(std::chrono::duration<float, std::milli>
+                          (now - previous_frame_end).count());
+  }
+  previous_frame_end = now;
+  frame++;
+  if(frame < option_int("REGRESSION_FRAMES", 120)){
+    return false;
+  }
+  check_image(chapter_number);
+  record_frame_times(chapter_number);
+  return true;
+}
+
+int
+regression_exit_status()
+{
+  return exit_status;
+}
+
+int
+regression_glfwGetKey(GLFWwindow *window,
+                      int key)
+{
+  if(!regression_child()){
+    return glfwGetKey(window, key);
+  }
+  const int step = frame / frames_per_key;
+  return step < script_length && script[step] == key ? GLFW_PRESS : GLFW_RELEASE;
+}
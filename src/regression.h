@@ -0,0 +1,67 @@
+#ifndef REGRESSION_H
+#define REGRESSION_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Golden-image regression and frame-time baseline.
+ *
+ * If MVP_REGRESSION=directory is set, the program does not ask for a
+ * chapter.  Instead it runs itself once for each of chapters 2 through
+ * 17, each in a fresh process, so that no chapter sees the static
+ * variables or the OpenGL context of another.  Each run uses an
+ * invisible window and vsync off, renders MVP_REGRESSION_FRAMES frames
+ * (default 120) while a fixed script holds down the keys, and then
+ * reads back the final frame.
+ *
+ * The frame is compared with "directory/chapterNN.ppm".  A chapter
+ * fails if any channel of any pixel differs by more than
+ * MVP_REGRESSION_TOLERANCE (default 2); the frame which was rendered
+ * is then written beside the golden image as "chapterNN.actual.ppm".
+ * MVP_REGRESSION_UPDATE=1 writes the golden images instead.
+ *
+ * The time between frames is appended, one line per chapter, to
+ * "directory/frame_times.csv".  The program exits with status 1 if any
+ * chapter failed.
+ */
+
+bool
+regression_requested();
+
+/* true in the process which renders one chapter */
+bool
+regression_child();
+
+/* run every chapter through "program".  Returns the exit status */
+int
+regression_run_all(const char *program);
+
+void
+regression_begin_frame();
+
+/* call after the last OpenGL call of the frame, before swapping.
+ * Returns true once the final frame has been checked.
+ */
+bool
+regression_end_frame(int chapter_number);
+
+/* 0, unless the chapter failed */
+int
+regression_exit_status();
+
+/* the fixed input script, in place of the keyboard */
+int
+regression_glfwGetKey(GLFWwindow *window,
+                      int key);
+
+#ifndef REGRESSION_IMPLEMENTATION
+#ifndef glfwGetKey
+#define glfwGetKey(window, key) regression_glfwGetKey(window, key)
+#endif
+#endif
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <system_error>
+#include <thread>
+#include "main.h"
+#include "options.h"
+#include "core_profile.h"
+#include "frame_capture.h"
+#include "frame_pacing.h"
+#include "input_latency.h"
+#include "startup.h"
+#include "timeline.h"
+#include "triple_buffer.h"
+#include "render_thread.h"
+
+typedef std::chrono::steady_clock step_clock;
+
+static bool active = false;
+static GLFWwindow *drawn_window = NULL;
+static std::thread drawer;
+static std::atomic<bool> stopping(false);
+// each scene, with the number of the step which made it
+struct numbered_scene {
+  core_profile_scene scene;
+  unsigned long step;
+};
+static triple_buffer<numbered_scene> scenes;
+
+// the simulation's schedule, on the main thread
+static step_clock::duration step_period;
+static step_clock::time_point next_step;
+
+// counters; each is written by one thread only
+static unsigned long steps = 0;
+static unsigned long late_steps = 0;
+static unsigned long dropped = 0;
+static unsigned long frames = 0;
+static unsigned long repeated = 0;
+
+bool
+render_thread_requested()
+{
+  return option_enabled("RENDER_THREAD") && !regression_child();
+}
+
+bool
+render_thread_active()
+{
+  return active;
+}
+
+// the render thread
+static void
+draw_scenes()
+{
+  timeline_name_thread("render");
+  glfwMakeContextCurrent(drawn_window);
+  // which the main thread enables every frame when it draws
+  glEnable(GL_DEPTH_TEST);
+  // nothing to draw until the first step
+  while(!stopping.load(std::memory_order_relaxed) && !scenes.update()){
+    std::this_thread::yield();
+  }
+  while(!stopping.load(std::memory_order_relaxed)){
+    timeline_zone frame_zone("frame");
+    if(!scenes.update()){
+      repeated++;
+    }
+    const core_profile_scene &scene = scenes.reader().scene;
+    glViewport(0, 0,
+               scene.framebuffer_width, scene.framebuffer_height);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    {
+      timeline_zone zone("draw");
+      core_profile_render(scene);
+    }
+    frame_capture_end_frame(scene.framebuffer_width, scene.framebuffer_height);
+    gl_trace_end_frame();
+    {
+      timeline_zone zone("swap");
+      glfwSwapBuffers(drawn_window);
+    }
+    startup_first_frame_presented();
+    input_latency_step_presented(scenes.reader().step);
+    frame_pacing_end_frame();
+    frames++;
+  }
+  glfwMakeContextCurrent(NULL);
+}
+
+bool
+render_thread_start(GLFWwindow *window)
+{
+  const double hz = option_double("SIMULATION_HZ", 60.0);
+  if(hz <= 0.0){
+    fprintf(stderr, "Error: MVP_SIMULATION_HZ must be positive\n");
+    return false;
+  }
+  step_period = std::chrono::duration_cast<step_clock::duration>
+    (std::chrono::duration<double>(1.0 / hz));
+  drawn_window = window;
+  stopping.store(false);
+  // a context may be current on only one thread at a time
+  glfwMakeContextCurrent(NULL);
+  try{
+    drawer = std::thread(draw_scenes);
+  }
+  catch(const std::system_error &e){
+    fprintf(stderr, "Error: cannot start the render thread: %s\n", e.what());
+    glfwMakeContextCurrent(window);
+    return false;
+  }
+  next_step = step_clock::now();
+  active = true;
+  return true;
+}
+
+void
+render_thread_publish(const core_profile_scene &scene)
+{
+  steps++;
+  scenes.writer().scene = scene;
+  scenes.writer().step = steps;
+  if(scenes.publish()){
+    dropped++;
+  }
+  input_latency_step_published(steps);
+}
+
+void
+render_thread_wait_for_step()
+{
+  timeline_zone zone("wait for step");
+  next_step += step_period;
+  step_clock::time_point now = step_clock::now();
+  if(now >= next_step){
+    // a late step; don't try to catch up by rushing the next ones
+    late_steps++;
+    next_step = now;
+    glfwPollEvents();
+    return;
+  }
+  // events are handled as they arrive, rather than once per step
+  while(now < next_step){
+    glfwWaitEventsTimeout(std::chrono::duration<double>(next_step - now).count());
+    now = step_clock::now();
+  }
+}
+
+void
+render_thread_stop()
+{
+  if(!active){
+    return;
+  }
+  stopping.store(true);
+  drawer.join();
+  glfwMakeContextCurrent(drawn_window);
+  active = false;
+}
+
+void
+render_thread_report()
+{
+  if(steps == 0){
+    return;
+  }
+  fprintf(stderr,
+          "render thread: %lu simulation steps (%lu late), %lu frames drawn, "
+          "%lu repeated a scene, %lu scenes dropped\n",
+          steps,
+          late_steps,
+          frames,
+          repeated,
+          dropped);
+}
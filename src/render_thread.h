@@ -0,0 +1,66 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Drawing on a thread of its own.
+ *
+ * Each frame, "render_scene" reads the keyboard and moves the
+ * chapter's objects, then submits the frame to OpenGL, and the event
+ * loop presents it with "glfwSwapBuffers", which may wait for the
+ * monitor's refresh.  While it waits, no key is read.
+ *
+ * If MVP_RENDER_THREAD=1 is set and the core-profile renderer is
+ * active (see "core_profile.h"), the window's context is moved to a
+ * render thread, which draws and presents frames.  The main thread
+ * handles events and moves the objects, MVP_SIMULATION_HZ times per
+ * second (default 60, so that the chapters move at their usual
+ * speed), and passes each resulting "core_profile_scene" to the render
+ * thread through a triple buffer (see "triple_buffer.h"); neither
+ * thread waits for the other.  The render thread draws the newest
+ * scene, so a scene may be drawn more than once, or replaced before it
+ * is drawn.
+ *
+ * The other chapters draw with glBegin and glEnd as they move their
+ * objects, so they always draw on the main thread.  Not used by
+ * regression runs, which need each frame to follow one step.  How
+ * many scenes were drawn, repeated and dropped is printed at exit.
+ */
+
+bool
+render_thread_requested();
+
+/* true between "render_thread_start" and "render_thread_stop" */
+bool
+render_thread_active();
+
+/* move the current context to a new render thread.  Returns false,
+ * after printing the reason to stderr, on failure; the context is
+ * then still current
+ */
+bool
+render_thread_start(GLFWwindow *window);
+
+/* hand the scene of this simulation step to the render thread */
+void
+render_thread_publish(const core_profile_scene &scene);
+
+/* handle events until the next simulation step is due */
+void
+render_thread_wait_for_step();
+
+/* stop drawing, and make the context current on the calling thread
+ * again
+ */
+void
+render_thread_stop();
+
+void
+render_thread_report();
+
+#endif
@@ -0,0 +1,283 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#define QUAD_BATCH_IMPLEMENTATION 1
+#define SPLIT_SCREEN_IMPLEMENTATION 1
+#include "main.h"
+#include "options.h"
+
+struct split_screen_cell {
+  int chapter;
+  // chapter 15 is chapter 14 with depth testing
+  bool depth_test;
+  // the moving camera's offset: x, y, z, rotation about y, about x
+  GLfloat camera[5];
+  // in the window's framebuffer
+  GLint x, y;
+  GLsizei width, height;
+};
+
+static std::vector<split_screen_cell> cells;
+// the cell being rendered, or -1
+static int current = -1;
+// the cell which reads the keyboard
+static int input_cell = 0;
+
+bool
+split_screen_requested()
+{
+  return option_string("SPLIT", NULL) != NULL && !regression_requested();
+}
+
+bool
+split_screen_active()
+{
+  return !cells.empty();
+}
+
+bool
+split_screen_init()
+{
+  const char *p = option_string("SPLIT", "");
+  // the chapters as given
+  std::vector<int> asked;
+  while(*p != '\0'){
+    split_screen_cell cell;
+    char *end;
+    cell.chapter = (int) strtol(p, &end, 10);
+    if(end == p || cell.chapter < 2 || cell.chapter > 17){
+      fprintf(stderr, "Error: MVP_SPLIT needs chapters 2 through 17, separated by commas\n");
+      cells.clear();
+      return false;
+    }
+    p = end;
+    // yaw and pitch in degrees, then x, y, z, in the order given
+    GLfloat view[5] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for(int i = 0; i < 5 && *p == ':'; i++){
+      view[i] = (GLfloat) strtod(p + 1, &end);
+      if(end == p + 1){
+        fprintf(stderr, "Error: MVP_SPLIT has a malformed view for chapter %d\n",
+                cell.chapter);
+        cells.clear();
+        return false;
+      }
+      p = end;
+    }
+    cell.camera[0] = view[2];
+    cell.camera[1] = view[3];
+    cell.camera[2] = view[4];
+    cell.camera[3] = view[0] / 57.296f;
+    cell.camera[4] = view[1] / 57.296f;
+    // the highest chapter reads the keyboard
+    const bool highest = cells.empty() || cell.chapter > asked[input_cell];
+    asked.push_back(cell.chapter);
+    cell.depth_test = cell.chapter >= 15;
+    if(cell.chapter == 15){
+      // which "render_scene" would change to 14 in a copy, drawing
+      // nothing, every frame
+      cell.chapter = 14;
+    }
+    cells.push_back(cell);
+    if(highest){
+      input_cell = (int) cells.size() - 1;
+    }
+    if(*p == ','){
+      p++;
+    }
+    else if(*p != '\0'){
+      fprintf(stderr, "Error: MVP_SPLIT has an unexpected '%c'\n", *p);
+      cells.clear();
+      return false;
+    }
+  }
+  if(cells.empty()){
+    fprintf(stderr, "Error: MVP_SPLIT lists no chapters\n");
+    return false;
+  }
+  return true;
+}
+
+int
+split_screen_highest_chapter()
+{
+  return cells[input_cell].chapter;
+}
+
+static void
+render_cell(int c,
+            void (*render)(int *chapter_number))
+{
+  // anything batched belongs to the previous cell
+  quad_batch_flush();
+  current = c;
+  const split_screen_cell &cell = cells[c];
+  glEnable(GL_SCISSOR_TEST);
+  glScissor(cell.x, cell.y, cell.width, cell.height);
+  glViewport(cell.x, cell.y, cell.width, cell.height);
+
+  // the state in which main leaves OpenGL, since each chapter expects
+  // to run alone
+  if(cell.depth_test){
+    glEnable(GL_DEPTH_TEST);
+  }
+  else{
+    glDisable(GL_DEPTH_TEST);
+  }
+  if(cell.chapter >= 17){
+    // as chapter 17 leaves it after its first frame
+    glClearDepth(1.1f);
+    glDepthFunc(GL_LEQUAL);
+  }
+  else{
+    glClearDepth(-1.1f);
+    glDepthFunc(GL_GREATER);
+  }
+  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  glMatrixMode(GL_MODELVIEW);
+  glLoadIdentity();
+
+  int chapter_number = cell.chapter;
+  render(&chapter_number);
+  quad_batch_flush();
+  current = -1;
+}
+
+void
+split_screen_render(void (*render)(int *chapter_number))
+{
+  int width, height;
+  glfwGetFramebufferSize(window, &width, &height);
+  const int columns = (int) std::ceil(std::sqrt((double) cells.size()));
+  const int rows = ((int) cells.size() + columns - 1) / columns;
+  for(size_t c = 0; c < cells.size(); c++){
+    // from the top left, across then down
+    const int column = (int) c % columns;
+    const int row = rows - 1 - (int) c / columns;
+    cells[c].x = column * width / columns;
+    cells[c].y = row * height / rows;
+    cells[c].width = (column + 1) * width / columns - cells[c].x;
+    cells[c].height = (row + 1) * height / rows - cells[c].y;
+  }
+  // cells left empty in the last row
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  // the keyboard moves the chapters before any cell is drawn, so that
+  // every cell shows the same moment
+  render_cell(input_cell, render);
+  for(size_t c = 0; c < cells.size(); c++){
+    if((int) c != input_cell){
+      render_cell((int) c, render);
+    }
+  }
+  glDisable(GL_SCISSOR_TEST);
+  glViewport(0, 0, width, height);
+}
+
+split_screen_camera::split_screen_camera(GLfloat *x,
+                                         GLfloat *y,
+                                         GLfloat *z,
+                                         GLfloat *rot_y,
+                                         GLfloat *rot_x)
+{
+  camera[0] = x;
+  camera[1] = y;
+  camera[2] = z;
+  camera[3] = rot_y;
+  camera[4] = rot_x;
+  for(int i = 0; i < 5; i++){
+    saved[i] = *camera[i];
+    if(current >= 0){
+      *camera[i] += cells[current].camera[i];
+    }
+    applied[i] = *camera[i];
+  }
+}
+
+split_screen_camera::~split_screen_camera()
+{
+  // keep what the chapter changed, e.g. by a key, without the cell's
+  // offset
+  for(int i = 0; i < 5; i++){
+    *camera[i] = saved[i] + (*camera[i] - applied[i]);
+  }
+}
+
+void
+split_screen_glViewport(GLint x,
+                        GLint y,
+                        GLsizei width,
+                        GLsizei height)
+{
+  if(current >= 0){
+    x += cells[current].x;
+    y += cells[current].y;
+  }
+  glViewport(x, y, width, height);
+}
+
+void
+split_screen_glScissor(GLint x,
+                       GLint y,
+                       GLsizei width,
+                       GLsizei height)
+{
+  if(current >= 0){
+    // within the cell, and no larger than it
+    const split_screen_cell &cell = cells[current];
+    const GLint min_x = std::max(cell.x, cell.x + x);
+    const GLint min_y = std::max(cell.y, cell.y + y);
+    const GLint max_x = std::min(cell.x + cell.width, cell.x + x + width);
+    const GLint max_y = std::min(cell.y + cell.height, cell.y + y + height);
+    x = min_x;
+    y = min_y;
+    width = std::max(0, max_x - min_x);
+    height = std::max(0, max_y - min_y);
+  }
+  glScissor(x, y, width, height);
+}
+
+void
+split_screen_glDisable(GLenum cap)
+{
+  if(current >= 0 && cap == GL_SCISSOR_TEST){
+    // confine the chapter to its cell instead
+    const split_screen_cell &cell = cells[current];
+    glScissor(cell.x, cell.y, cell.width, cell.height);
+    return;
+  }
+  glDisable(cap);
+}
+
+void
+split_screen_glfwGetFramebufferSize(GLFWwindow *window,
+                                    int *width,
+                                    int *height)
+{
+  if(current >= 0){
+    *width = cells[current].width;
+    *height = cells[current].height;
+    return;
+  }
+  glfwGetFramebufferSize(window, width, height);
+}
+
+int
+split_screen_glfwGetKey(GLFWwindow *window,
+                        int key)
+{
+  if(current >= 0 && current != input_cell){
+    return GLFW_RELEASE;
+  }
+  return glfwGetKey(window, key);
+}
@@ -0,0 +1,115 @@
+#ifndef SPLIT_SCREEN_H
+#define SPLIT_SCREEN_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Several chapters, or several views of one, in one window.
+ *
+ * If MVP_SPLIT is set, the program does not ask for a chapter.  The
+ * window is instead divided into a grid of cells, one for each entry
+ * of the comma-separated list MVP_SPLIT, and every cell is rendered
+ * each frame.  An entry is
+ *
+ *   chapter[:yaw[:pitch[:x:y:z]]]
+ *
+ * where the optional yaw and pitch, in degrees, turn the moving camera
+ * of chapters 14 and later, and x, y and z move it, for that cell only.
+ * For example, MVP_SPLIT=9,14,17,17:180:0:0:-800 shows chapters 9 and
+ * 14, and chapter 17 from the front and from behind.
+ *
+ * The cells share the chapters' state, and the keyboard is read only
+ * while rendering the cell with the highest chapter, which is rendered
+ * first; the other cells see no keys held.  Each object's transformed
+ * vertices are kept for each camera (see "transform_cache.h"), so that
+ * cells which share a camera transform them only once.
+ *
+ * While a cell is rendered, the macros at the end of this file confine
+ * the chapter to it: viewports and scissor rectangles are moved into
+ * the cell, the scissor test is never disabled, and the framebuffer
+ * size reported is the cell's.  This layer sits below the quad batcher
+ * and above the state cache.
+ *
+ * Not available with the core profile, nor during regression runs.
+ */
+
+bool
+split_screen_requested();
+
+bool
+split_screen_active();
+
+/* parse MVP_SPLIT.  Returns false, after printing the reason to
+ * stderr, if it is malformed
+ */
+bool
+split_screen_init();
+
+/* the chapter whose cell reads the keyboard */
+int
+split_screen_highest_chapter();
+
+/* render every cell, calling "render" with each cell's chapter */
+void
+split_screen_render(void (*render)(int *chapter_number));
+
+/* While it exists, the moving camera is moved to the view of the cell
+ * being rendered; afterwards it is moved back.  Whatever the chapter
+ * itself changed meanwhile, e.g. by a key, is kept.
+ */
+class split_screen_camera {
+public:
+  split_screen_camera(GLfloat *x,
+                      GLfloat *y,
+                      GLfloat *z,
+                      GLfloat *rot_y,
+                      GLfloat *rot_x);
+  ~split_screen_camera();
+private:
+  GLfloat *camera[5];
+  GLfloat saved[5];
+  GLfloat applied[5];
+};
+
+void
+split_screen_glViewport(GLint x,
+                        GLint y,
+                        GLsizei width,
+                        GLsizei height);
+void
+split_screen_glScissor(GLint x,
+                       GLint y,
+                       GLsizei width,
+                       GLsizei height);
+void
+split_screen_glDisable(GLenum cap);
+void
+split_screen_glfwGetFramebufferSize(GLFWwindow *window,
+                                    int *width,
+                                    int *height);
+int
+split_screen_glfwGetKey(GLFWwindow *window,
+                        int key);
+
+#ifndef SPLIT_SCREEN_IMPLEMENTATION
+#ifndef glViewport
+#define glViewport(x, y, width, height) \
+  split_screen_glViewport(x, y, width, height)
+#endif
+#ifndef glScissor
+#define glScissor(x, y, width, height) \
+  split_screen_glScissor(x, y, width, height)
+#endif
+#ifndef glDisable
+#define glDisable(cap) split_screen_glDisable(cap)
+#endif
+#define glfwGetFramebufferSize(window, width, height) \
+  split_screen_glfwGetFramebufferSize(window, width, height)
+#define glfwGetKey(window, key) split_screen_glfwGetKey(window, key)
+#endif
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include "main.h"
+#include "options.h"
+#include "timeline.h"
+#include "startup.h"
+
+typedef std::chrono::steady_clock startup_clock;
+
+// as near to the start of the program as can be measured from within
+static const startup_clock::time_point started = startup_clock::now();
+
+struct startup_phase_time {
+  const char *name;
+  startup_clock::time_point begin;
+  bool waiting;
+  // on the timeline, if it is enabled
+  int64_t zone;
+};
+
+static const int max_phases = 16;
+static startup_phase_time phases[max_phases];
+static int number_of_phases = 0;
+static std::atomic<bool> presented(false);
+
+bool
+startup_fast()
+{
+  static const bool result = option_enabled("FAST_START");
+  return result;
+}
+
+static double
+milliseconds(startup_clock::duration d)
+{
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+double
+startup_milliseconds()
+{
+  return milliseconds(startup_clock::now() - started);
+}
+
+static void
+begin_phase(const char *name,
+            bool waiting,
+            bool on_timeline)
+{
+  const startup_clock::time_point now = startup_clock::now();
+  if(number_of_phases > 0){
+    const startup_phase_time &current = phases[number_of_phases - 1];
+    timeline_end_zone(current.name, current.zone);
+  }
+  if(number_of_phases == max_phases){
+    return;
+  }
+  startup_phase_time &phase = phases[number_of_phases++];
+  phase.name = name;
+  // the first phase began with the program
+  phase.begin = number_of_phases == 1 ? started : now;
+  phase.waiting = waiting;
+  phase.zone = on_timeline ? timeline_begin_zone() : -1;
+}
+
+void
+startup_phase(const char *name)
+{
+  begin_phase(name, /*waiting*/ false, /*on_timeline*/ true);
+}
+
+void
+startup_waiting_phase(const char *name)
+{
+  begin_phase(name, /*waiting*/ true, /*on_timeline*/ true);
+}
+
+void
+startup_initialized()
+{
+  // the first frame has a zone of its own, "frame", which may be on
+  // another thread
+  begin_phase("first frame", /*waiting*/ false, /*on_timeline*/ false);
+}
+
+void
+startup_first_frame_presented()
+{
+  if(presented.exchange(true)){
+    return;
+  }
+  const startup_clock::time_point now = startup_clock::now();
+  if(!(option_enabled("STARTUP_TIMES") || startup_fast()) || number_of_phases == 0){
+    return;
+  }
+  startup_clock::duration waited = startup_clock::duration::zero();
+  fprintf(stderr, "startup:");
+  for(int p = 0; p < number_of_phases; p++){
+    const startup_clock::time_point end =
+      p + 1 < number_of_phases ? phases[p + 1].begin : now;
+    fprintf(stderr,
+            "%s %s %.1f ms%s",
+            p == 0 ? "" : ",",
+            phases[p].name,
+            milliseconds(end - phases[p].begin),
+            phases[p].waiting ? " (waiting)" : "");
+    if(phases[p].waiting){
+      waited += end - phases[p].begin;
+    }
+  }
+  fprintf(stderr, "\n");
+  if(waited > startup_clock::duration::zero()){
+    fprintf(stderr,
+            "startup: first frame presented after %.1f ms, not counting %.1f ms of waiting\n",
+            milliseconds(now - started - waited),
+            milliseconds(waited));
+  }
+  else{
+    fprintf(stderr,
+            "startup: first frame presented after %.1f ms\n",
+            milliseconds(now - started));
+  }
+}
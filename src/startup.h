@@ -0,0 +1,64 @@
+#ifndef STARTUP_H
+#define STARTUP_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* How long the program takes to show its first frame.
+ *
+ * Startup is a sequence of phases (reading the arguments, initializing
+ * GLFW, creating the window, making its context current and loading
+ * OpenGL's procedures, ...), each begun by "startup_phase", which ends
+ * the one before.  The last phase, drawing and presenting the first
+ * frame, begins with "startup_initialized" and ends when
+ * "startup_first_frame_presented" is first called.  Each phase but the
+ * last is also a zone on the main thread's timeline (see "timeline.h");
+ * the last is the first "frame" zone.
+ *
+ * If MVP_STARTUP_TIMES=1 is set, each phase's duration and the time to
+ * the first frame are printed to stderr once it is presented.  Time
+ * spent waiting for the user to type a chapter number is shown, but
+ * not counted in the time to the first frame.
+ *
+ * Setting MVP_FAST_START=1 (or passing --fast-start) is meant for
+ * programs restarted often, such as kiosks and render workers: the
+ * chapter must be given, as MVP_CHAPTER or on the command line, so
+ * that nothing is asked, the mesh of MVP_MESH is imported on a thread
+ * of its own while the square is drawn in its place (see
+ * "mesh_model.h"), and the startup times are printed.
+ */
+
+bool
+startup_fast();
+
+/* end the current phase, if any, and begin "name", which must outlive
+ * the program, e.g. a string literal
+ */
+void
+startup_phase(const char *name);
+
+/* as "startup_phase", for a phase spent waiting for the user */
+void
+startup_waiting_phase(const char *name);
+
+/* the phases of initialization are over, and the first frame is
+ * being drawn
+ */
+void
+startup_initialized();
+
+/* may be called from any thread, after every swap; only the first
+ * call counts
+ */
+void
+startup_first_frame_presented();
+
+/* the milliseconds since the program started */
+double
+startup_milliseconds();
+
+#endif
@@ -0,0 +1,197 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define STREAM_BUFFER_USE_SSE 1
+#endif
+#include "main.h"
+#include "options.h"
+#include "stream_buffer.h"
+
+// one quadrilateral: 4 vertices of x, y, and z.  48 bytes, which
+// is a multiple of the 16 bytes written by each streaming store
+static const GLsizeiptr quad_bytes = 4 * 3 * sizeof(GLfloat);
+static const GLsizeiptr vertex_bytes = 3 * sizeof(GLfloat);
+
+static bool active = false;
+static GLuint buffer = 0;
+static char *mapped = NULL;
+static int number_of_slices = 0;
+static GLsizeiptr slice_bytes = 0;
+static std::vector<GLsync> fences;
+static int current_slice = 0;
+static GLsizeiptr write_offset = 0;
+
+// counters
+static unsigned long frames = 0;
+static unsigned long fence_checks = 0;
+static unsigned long fence_waits = 0;
+static double fence_wait_seconds = 0.0;
+static unsigned long quads_written = 0;
+static unsigned long slice_overflows = 0;
+
+bool
+stream_buffer_requested()
+{
+  return option_enabled("STREAM_BUFFER");
+}
+
+bool
+stream_buffer_active()
+{
+  return active;
+}
+
+bool
+stream_buffer_init()
+{
+  if(!GLEW_ARB_buffer_storage || !GLEW_ARB_sync){
+    fprintf(stderr,
+            "Error: MVP_STREAM_BUFFER requires GL_ARB_buffer_storage and GL_ARB_sync\n");
+    return false;
+  }
+  number_of_slices = option_int("STREAM_BUFFER_SLICES", 3);
+  if(number_of_slices < 2){
+    number_of_slices = 2;
+  }
+  // round the size of a slice down to a whole number of quadrilaterals
+  slice_bytes = (GLsizeiptr) option_int("STREAM_BUFFER_SLICE_KB", 256) * 1024;
+  slice_bytes -= slice_bytes % quad_bytes;
+  if(slice_bytes < quad_bytes){
+    slice_bytes = quad_bytes;
+  }
+  const GLbitfield flags =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  glBufferStorage(GL_ARRAY_BUFFER,
+                  slice_bytes * number_of_slices,
+                  NULL,
+                  flags);
+  mapped = (char *) glMapBufferRange(GL_ARRAY_BUFFER,
+                                     0,
+                                     slice_bytes * number_of_slices,
+                                     flags);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  if(mapped == NULL){
+    fprintf(stderr, "Error: could not map the stream buffer\n");
+    glDeleteBuffers(1, &buffer);
+    return false;
+  }
+  fences.assign(number_of_slices, (GLsync) 0);
+  current_slice = 0;
+  active = true;
+  return true;
+}
+
+void
+stream_buffer_begin_frame()
+{
+  if(!active){
+    return;
+  }
+  current_slice = frames % number_of_slices;
+  write_offset = 0;
+  GLsync fence = fences[current_slice];
+  if(fence){
+    fence_checks++;
+    // the common case: the driver finished with this slice long ago
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if(status == GL_TIMEOUT_EXPIRED){
+      fence_waits++;
+      std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+      do {
+        status = glClientWaitSync(fence,
+                                  GL_SYNC_FLUSH_COMMANDS_BIT,
+                                  /*nanoseconds*/ 1000000000);
+      } while(status == GL_TIMEOUT_EXPIRED);
+      fence_wait_seconds += std::chrono::duration<double>
+        (std::chrono::steady_clock::now() - start).count();
+    }
+    glDeleteSync(fence);
+    fences[current_slice] = 0;
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(/*size*/ 3,
+                  GL_FLOAT,
+                  /*stride*/ 0,
+                  /*offset*/ 0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void
+stream_buffer_end_frame()
+{
+  if(!active){
+    return;
+  }
+  glDisableClientState(GL_VERTEX_ARRAY);
+  fences[current_slice] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  frames++;
+}
+
+bool
+stream_buffer_draw_quad(const GLfloat vertices[12])
+{
+  if(write_offset + quad_bytes > slice_bytes){
+    slice_overflows++;
+    return false;
+  }
+  const GLsizeiptr offset = current_slice * slice_bytes + write_offset;
+  float *destination = (float *) (mapped + offset);
+#ifdef STREAM_BUFFER_USE_SSE
+  // bypass the CPU's caches; the CPU never reads this memory back
+  _mm_stream_ps(destination + 0, _mm_loadu_ps(vertices + 0));
+  _mm_stream_ps(destination + 4, _mm_loadu_ps(vertices + 4));
+  _mm_stream_ps(destination + 8, _mm_loadu_ps(vertices + 8));
+  // make the streamed stores visible before the driver reads them
+  _mm_sfence();
+#else
+  memcpy(destination, vertices, quad_bytes);
+#endif
+  write_offset += quad_bytes;
+  quads_written++;
+  glDrawArrays(GL_QUADS,
+               /*first*/ (GLint) (offset / vertex_bytes),
+               /*count*/ 4);
+  return true;
+}
+
+void
+stream_buffer_shutdown()
+{
+  if(!active){
+    return;
+  }
+  fprintf(stderr,
+          "stream buffer: %lu frames, %lu quads, %lu slice overflows\n"
+          "stream buffer: %lu fences checked, %lu waited on, %.3f ms waiting\n",
+          frames,
+          quads_written,
+          slice_overflows,
+          fence_checks,
+          fence_waits,
+          fence_wait_seconds * 1000.0);
+  for(size_t i = 0; i < fences.size(); i++){
+    if(fences[i]){
+      glDeleteSync(fences[i]);
+    }
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDeleteBuffers(1, &buffer);
+  mapped = NULL;
+  active = false;
+}
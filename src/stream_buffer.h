@@ -0,0 +1,55 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Streaming vertex buffer for geometry which changes every frame.
+ *
+ * One buffer object is allocated with "glBufferStorage" and mapped
+ * once, persistently and coherently, for the life of the program.
+ * It is split into MVP_STREAM_BUFFER_SLICES slices; each frame
+ * writes into the next slice, and a fence placed at the end of the
+ * frame tells us when the driver has finished reading it.  Only when
+ * the CPU laps the driver does it have to wait on that fence.
+ *
+ * Enabled by setting MVP_STREAM_BUFFER=1 in the environment.
+ * Requires GL_ARB_buffer_storage and GL_ARB_sync.
+ */
+
+bool
+stream_buffer_requested();
+
+bool
+stream_buffer_active();
+
+/* allocate and map the buffer.  Returns false, after printing the
+ * reason to stderr, if the extensions are unavailable.
+ */
+bool
+stream_buffer_init();
+
+/* wait, if need be, until this frame's slice is free to be written */
+void
+stream_buffer_begin_frame();
+
+/* fence the slice written during this frame */
+void
+stream_buffer_end_frame();
+
+/* write the 4 vertices (x,y,z each) of a quadrilateral into the
+ * current slice and draw it with the current color.  Returns false
+ * if the slice is full, in which case nothing was drawn.
+ */
+bool
+stream_buffer_draw_quad(const GLfloat vertices[12]);
+
+/* print the counters to stderr, then unmap and free the buffer */
+void
+stream_buffer_shutdown();
+
+#endif
@@ -0,0 +1,381 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "main.h"
+#include "options.h"
+#include "timeline.h"
+
+typedef std::chrono::steady_clock timeline_clock;
+
+// one zone, as recorded
+struct timeline_event {
+  int64_t begin, end;
+  const char *name;
+  uint32_t depth;
+};
+
+struct timeline_thread {
+  int id;
+  const char *name;
+  // a ring, of a power of two in size
+  std::vector<timeline_event> events;
+  uint64_t written;
+  // the zones open now
+  uint32_t depth;
+};
+
+static std::mutex threads_mutex;
+static std::vector<timeline_thread *> threads;
+static thread_local timeline_thread *this_thread = NULL;
+
+bool
+timeline_enabled()
+{
+  static const bool result =
+    option_string("TRACE", NULL) != NULL && !regression_child();
+  return result;
+}
+
+static int64_t
+now()
+{
+  static const timeline_clock::time_point start = timeline_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>
+    (timeline_clock::now() - start).count();
+}
+
+static timeline_thread *
+current_thread()
+{
+  if(this_thread){
+    return this_thread;
+  }
+  size_t capacity = 1;
+  const int wanted = std::max(1, option_int("TRACE_EVENTS", 262144));
+  while(capacity < (size_t) wanted){
+    capacity *= 2;
+  }
+  timeline_thread *thread = new timeline_thread;
+  thread->name = NULL;
+  thread->events.resize(capacity);
+  thread->written = 0;
+  thread->depth = 0;
+  {
+    std::lock_guard<std::mutex> lock(threads_mutex);
+    threads.push_back(thread);
+    thread->id = (int) threads.size();
+  }
+  this_thread = thread;
+  return thread;
+}
+
+int64_t
+timeline_begin_zone()
+{
+  if(!timeline_enabled()){
+    return -1;
+  }
+  current_thread()->depth++;
+  return now();
+}
+
+void
+timeline_end_zone(const char *name,
+                  int64_t begin)
+{
+  if(begin < 0){
+    return;
+  }
+  const int64_t end = now();
+  timeline_thread *thread = current_thread();
+  thread->depth--;
+  timeline_event &event =
+    thread->events[thread->written & (thread->events.size() - 1)];
+  event.begin = begin;
+  event.end = end;
+  event.name = name;
+  event.depth = thread->depth;
+  thread->written++;
+}
+
+void
+timeline_name_thread(const char *name)
+{
+  if(timeline_enabled()){
+    current_thread()->name = name;
+  }
+}
+
+const char *
+timeline_chapter_name(int chapter)
+{
+  static const char *names[] = {
+    "chapter 0",  "chapter 1",  "chapter 2",  "chapter 3",  "chapter 4",
+    "chapter 5",  "chapter 6",  "chapter 7",  "chapter 8",  "chapter 9",
+    "chapter 10", "chapter 11", "chapter 12", "chapter 13", "chapter 14",
+    "chapter 15", "chapter 16", "chapter 17", "chapter 18", "chapter 19",
+    "chapter 20"
+  };
+  if(chapter < 0 || chapter >= (int) (sizeof(names) / sizeof(names[0]))){
+    return "chapter";
+  }
+  return names[chapter];
+}
+
+// the events still in a thread's ring, oldest first
+static std::vector<timeline_event>
+kept_events(const timeline_thread &thread)
+{
+  const uint64_t size = thread.events.size();
+  const uint64_t first = thread.written > size ? thread.written - size : 0;
+  std::vector<timeline_event> result;
+  result.reserve((size_t) (thread.written - first));
+  for(uint64_t i = first; i < thread.written; i++){
+    result.push_back(thread.events[i & (size - 1)]);
+  }
+  return result;
+}
+
+static const char *
+name_of(const timeline_thread &thread)
+{
+  return thread.name ? thread.name : "thread";
+}
+
+static void
+write_json_string(FILE *file,
+                  const char *s)
+{
+  fputc('"', file);
+  for(; *s; s++){
+    if(*s == '"' || *s == '\\'){
+      fputc('\\', file);
+    }
+    fputc(*s, file);
+  }
+  fputc('"', file);
+}
+
+// Chrome's trace event format: a "complete" event per zone, with
+// times in microseconds
+static void
+write_json(FILE *file)
+{
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool first = true;
+  for(size_t t = 0; t < threads.size(); t++){
+    const timeline_thread &thread = *threads[t];
+    fprintf(file,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+            first ? "" : ",\n",
+            thread.id);
+    write_json_string(file, name_of(thread));
+    fprintf(file, "}}");
+    first = false;
+    const std::vector<timeline_event> events = kept_events(thread);
+    for(size_t e = 0; e < events.size(); e++){
+      fprintf(file, ",\n{\"name\":");
+      write_json_string(file, events[e].name);
+      fprintf(file,
+              ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+              thread.id,
+              events[e].begin / 1000.0,
+              (events[e].end - events[e].begin) / 1000.0);
+    }
+  }
+  fprintf(file, "\n]}\n");
+}
+
+// protobuf's encoding, enough of it for a Perfetto trace
+static void
+put_varint(std::string *out,
+           uint64_t value)
+{
+  while(value >= 0x80){
+    out->push_back((char) ((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back((char) value);
+}
+
+static void
+put_uint(std::string *out,
+         int field,
+         uint64_t value)
+{
+  put_varint(out, (uint64_t) field << 3);
+  put_varint(out, value);
+}
+
+static void
+put_bytes(std::string *out,
+          int field,
+          const char *bytes,
+          size_t length)
+{
+  put_varint(out, ((uint64_t) field << 3) | 2);
+  put_varint(out, length);
+  out->append(bytes, length);
+}
+
+static void
+put_message(std::string *out,
+            int field,
+            const std::string &message)
+{
+  put_bytes(out, field, message.data(), message.size());
+}
+
+// field numbers, from Perfetto's trace_packet.proto, track_event.proto
+// and track_descriptor.proto
+enum {
+  trace_packet = 1,
+  packet_timestamp = 8,
+  packet_sequence_id = 10,
+  packet_track_event = 11,
+  packet_sequence_flags = 13,
+  packet_track_descriptor = 60,
+  event_type = 9,
+  event_track_uuid = 11,
+  event_name = 23,
+  event_slice_begin = 1,
+  event_slice_end = 2,
+  descriptor_uuid = 1,
+  descriptor_thread = 4,
+  thread_pid = 1,
+  thread_tid = 2,
+  thread_name = 5,
+  incremental_state_cleared = 1
+};
+
+// in the order zones began; an outer zone before those within it
+static bool
+began_before(const timeline_event &a,
+             const timeline_event &b)
+{
+  if(a.begin != b.begin){
+    return a.begin < b.begin;
+  }
+  return a.depth < b.depth;
+}
+
+static void
+write_packet(FILE *file,
+             const std::string &packet)
+{
+  std::string framed;
+  put_message(&framed, trace_packet, packet);
+  fwrite(framed.data(), 1, framed.size(), file);
+}
+
+static void
+write_perfetto(FILE *file)
+{
+  std::string packet, message, inner;
+  for(size_t t = 0; t < threads.size(); t++){
+    const timeline_thread &thread = *threads[t];
+    const uint64_t track = (uint64_t) thread.id;
+    // each thread is a sequence of its own, and a track
+    inner.clear();
+    put_uint(&inner, thread_pid, 1);
+    put_uint(&inner, thread_tid, (uint64_t) thread.id);
+    put_bytes(&inner, thread_name, name_of(thread), strlen(name_of(thread)));
+    message.clear();
+    put_uint(&message, descriptor_uuid, track);
+    put_message(&message, descriptor_thread, inner);
+    packet.clear();
+    put_uint(&packet, packet_sequence_id, (uint64_t) thread.id);
+    put_uint(&packet, packet_sequence_flags, incremental_state_cleared);
+    put_message(&packet, packet_track_descriptor, message);
+    write_packet(file, packet);
+
+    // Perfetto reads each zone as its beginning and its end, which
+    // must be in order.  Each zone ends before the next one at its
+    // depth, or above, begins.
+    std::vector<timeline_event> events = kept_events(thread);
+    std::sort(events.begin(), events.end(), began_before);
+    std::vector<const timeline_event *> open;
+    int64_t last = 0;
+    auto edge = [&](int64_t time, const char *name){
+      // time never goes backwards along a track
+      last = std::max(last, time);
+      message.clear();
+      put_uint(&message, event_type, name ? event_slice_begin : event_slice_end);
+      put_uint(&message, event_track_uuid, track);
+      if(name){
+        put_bytes(&message, event_name, name, strlen(name));
+      }
+      packet.clear();
+      put_uint(&packet, packet_timestamp, (uint64_t) last);
+      put_uint(&packet, packet_sequence_id, (uint64_t) thread.id);
+      put_message(&packet, packet_track_event, message);
+      write_packet(file, packet);
+    };
+    for(size_t e = 0; e < events.size(); e++){
+      while(!open.empty() && open.back()->depth >= events[e].depth){
+        edge(open.back()->end, NULL);
+        open.pop_back();
+      }
+      edge(events[e].begin, events[e].name);
+      open.push_back(&events[e]);
+    }
+    while(!open.empty()){
+      edge(open.back()->end, NULL);
+      open.pop_back();
+    }
+  }
+}
+
+void
+timeline_shutdown()
+{
+  if(!timeline_enabled()){
+    return;
+  }
+  const char *path = option_string("TRACE", NULL);
+  const size_t length = strlen(path);
+  const bool json = length >= 5 && strcmp(path + length - 5, ".json") == 0;
+  FILE *file = fopen(path, "wb");
+  if(!file){
+    fprintf(stderr, "Error: cannot write the trace to %s\n", path);
+  }
+  else{
+    if(json){
+      write_json(file);
+    }
+    else{
+      write_perfetto(file);
+    }
+    fclose(file);
+  }
+  unsigned long long zones = 0, overwritten = 0;
+  for(size_t t = 0; t < threads.size(); t++){
+    const timeline_thread &thread = *threads[t];
+    const uint64_t size = thread.events.size();
+    zones += std::min(thread.written, size);
+    overwritten += thread.written > size ? thread.written - size : 0;
+    delete threads[t];
+  }
+  if(file){
+    fprintf(stderr,
+            "timeline: %llu zones on %lu threads written to %s (%llu overwritten)\n",
+            zones,
+            (unsigned long) threads.size(),
+            path,
+            overwritten);
+  }
+  threads.clear();
+  this_thread = NULL;
+}
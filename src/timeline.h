@@ -0,0 +1,83 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+
+/* A timeline of what each thread spent each frame doing.
+ *
+ * The phases of a frame (drawing each chapter, transforming its
+ * vertices, swapping buffers, polling for events, ...) are marked by
+ * "timeline_zone"s, each timed from its construction to the end of its
+ * scope:
+ *
+ *   {
+ *     timeline_zone zone("swap");
+ *     glfwSwapBuffers(window);
+ *   }
+ *
+ * Each thread records into a buffer of its own, so recording takes no
+ * lock: only the first zone on a thread takes one, to make the
+ * thread's buffer known.  A buffer is a ring of MVP_TRACE_EVENTS zones
+ * (default 262144); if a thread records more, the oldest are
+ * overwritten, so that the end of a long run is kept.  When disabled,
+ * a zone costs two calls which return at once.
+ *
+ * Enabled by setting MVP_TRACE to the name of the file to write at
+ * exit.  If it ends in ".json", the file is in Chrome's trace event
+ * format, for chrome://tracing; otherwise it is a Perfetto protobuf
+ * trace, for ui.perfetto.dev.  Both show each thread's zones, nested,
+ * on a timeline.
+ */
+
+bool
+timeline_enabled();
+
+/* the start of a zone, in nanoseconds; a negative value, if
+ * disabled, which "timeline_end_zone" ignores
+ */
+int64_t
+timeline_begin_zone();
+
+/* "name" must outlive the program, e.g. a string literal */
+void
+timeline_end_zone(const char *name,
+                  int64_t begin);
+
+class timeline_zone {
+public:
+  explicit timeline_zone(const char *the_name):
+    name(the_name),
+    begin(timeline_begin_zone())
+  {}
+  ~timeline_zone()
+  {
+    timeline_end_zone(name, begin);
+  }
+private:
+  timeline_zone(const timeline_zone &);
+  timeline_zone &operator=(const timeline_zone &);
+  const char *name;
+  int64_t begin;
+};
+
+/* the name to show for the calling thread */
+void
+timeline_name_thread(const char *name);
+
+/* "chapter 1", "chapter 2", ...; a name for zones which lasts */
+const char *
+timeline_chapter_name(int chapter);
+
+/* write the file, after every other thread has stopped, and print how
+ * many zones it holds
+ */
+void
+timeline_shutdown();
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <cstdio>
+#include <cstring>
+#include "main.h"
+#include "options.h"
+#include "transform_cache.h"
+
+// counters
+static unsigned long hits = 0;
+static unsigned long misses = 0;
+
+bool
+transform_cache_enabled()
+{
+  static const bool result = option_enabled("TRANSFORM_CACHE");
+  return result;
+}
+
+uint64_t
+transform_cache_hash(const GLfloat *inputs,
+                     size_t count)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for(size_t i = 0; i < count; i++){
+    uint32_t bits;
+    memcpy(&bits, &inputs[i], sizeof(bits));
+    hash = (hash ^ bits) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+void
+transform_cache_record(bool hit)
+{
+  if(hit){
+    hits++;
+  }
+  else{
+    misses++;
+  }
+}
+
+void
+transform_cache_report()
+{
+  if(!transform_cache_enabled() || hits + misses == 0){
+    return;
+  }
+  fprintf(stderr,
+          "transform cache: %lu hits, %lu misses, %.1f%% of objects not transformed\n",
+          hits,
+          misses,
+          100.0 * hits / (hits + misses));
+}
@@ -0,0 +1,183 @@
+#ifndef TRANSFORM_CACHE_H
+#define TRANSFORM_CACHE_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+#include "timeline.h"
+#include "vertex_capture.h"
+
+/* A cache of one object's transformed vertices.
+ *
+ * In chapters 9 through 14 every vertex is transformed on the CPU,
+ * every frame, although an object's vertices change only when one of
+ * the values its transformations use (its offsets, rotations, and the
+ * camera's position) changes, which is only while a key is held.
+ *
+ * Each object which is drawn keeps a "transform_cache".  Before
+ * transforming its vertices, the object asks the cache whether it
+ * holds vertices transformed with those values; the values are
+ * compared by a hash first, then exactly.  Only if not are the
+ * vertices transformed again, and "add"ed to the cache.  A few sets of
+ * values are kept, so that the views of a split screen (see
+ * "split_screen.h") do not evict each other.  "transform_cached" does
+ * all of that for an object's listing, which gives it only the values,
+ * the vertices, and how to transform one of them.
+ *
+ * Chapter 16 is not cached.  Its objects are given to
+ * "draw_square3_programmable" as a transformation composed from a
+ * stack of functions, which do not show the values they use, and each
+ * of their transformed vertices is then clipped, culled, or streamed,
+ * with a level of detail which depends on its projected size; there is
+ * no key cheaper than transforming them again.
+ *
+ * Enabled by setting MVP_TRANSFORM_CACHE=1 in the environment; when
+ * disabled, every lookup misses.  The number of hits and misses is
+ * printed to stderr at exit.
+ */
+
+bool
+transform_cache_enabled();
+
+/* FNV-1a of the bits of "inputs" */
+uint64_t
+transform_cache_hash(const GLfloat *inputs,
+                     size_t count);
+
+/* count a lookup */
+void
+transform_cache_record(bool hit);
+
+void
+transform_cache_report();
+
+/* a vertex in each space it passes through */
+template<typename V>
+struct transformed_vertex {
+  V modelspace;
+  V worldSpace;
+  V cameraSpace;
+  V ndcSpace;
+};
+
+template<typename V>
+class transform_cache {
+public:
+  transform_cache():
+    current(0),
+    uses(0)
+  {}
+
+  /* true if vertices transformed with "values" are cached.  If not,
+   * the least recently used entry is emptied, to be refilled by "add"
+   */
+  bool
+  hit(std::initializer_list<GLfloat> values)
+  {
+    const uint64_t key = transform_cache_hash(values.begin(), values.size());
+    uses++;
+    for(size_t e = 0; transform_cache_enabled() && e < entries.size(); e++){
+      entry &candidate = entries[e];
+      if(candidate.key == key
+         && !candidate.transformed.empty()
+         && values.size() == candidate.inputs.size()
+         && std::equal(values.begin(), values.end(), candidate.inputs.begin())){
+        candidate.last_used = uses;
+        current = e;
+        transform_cache_record(true);
+        return true;
+      }
+    }
+    transform_cache_record(false);
+    if(entries.size() < maximum_entries){
+      entries.push_back(entry());
+      current = entries.size() - 1;
+    }
+    else{
+      current = 0;
+      for(size_t e = 1; e < entries.size(); e++){
+        if(entries[e].last_used < entries[current].last_used){
+          current = e;
+        }
+      }
+    }
+    entry &replaced = entries[current];
+    replaced.key = key;
+    replaced.inputs.assign(values.begin(), values.end());
+    replaced.transformed.clear();
+    replaced.last_used = uses;
+    return false;
+  }
+
+  void
+  add(const V &modelspace,
+      const V &worldSpace,
+      const V &cameraSpace,
+      const V &ndcSpace)
+  {
+    const transformed_vertex<V> v = {modelspace, worldSpace, cameraSpace, ndcSpace};
+    entries[current].transformed.push_back(v);
+  }
+
+  /* those of the last "hit" */
+  const std::vector<transformed_vertex<V> > &
+  vertices() const
+  {
+    return entries[current].transformed;
+  }
+
+private:
+  // one for each camera of a split screen
+  static const size_t maximum_entries = 8;
+  struct entry {
+    uint64_t key;
+    std::vector<GLfloat> inputs;
+    std::vector<transformed_vertex<V> > transformed;
+    unsigned long last_used;
+  };
+  std::vector<entry> entries;
+  size_t current;
+  unsigned long uses;
+};
+
+/* the vertices of "object", transformed by "transform", which returns
+ * a "transformed_vertex<V>" for a vertex in model space, again only if
+ * "values" are not cached.  Each is captured (see "vertex_capture.h")
+ * before it is returned.
+ */
+template<typename V, typename F>
+const std::vector<transformed_vertex<V> > &
+transform_cached(transform_cache<V> &cache,
+                 int object,
+                 std::initializer_list<GLfloat> values,
+                 const std::vector<V> &vertices,
+                 F transform)
+{
+  if(!cache.hit(values)){
+    timeline_zone transform_zone("transform");
+    for(const V &modelspace : vertices){
+      const transformed_vertex<V> v = transform(modelspace);
+      cache.add(v.modelspace,
+                v.worldSpace,
+                v.cameraSpace,
+                v.ndcSpace);
+    }
+  }
+  for(const transformed_vertex<V> &v : cache.vertices()){
+    vertex_capture(object,
+                   v.modelspace,
+                   v.worldSpace,
+                   v.cameraSpace,
+                   v.ndcSpace);
+  }
+  return cache.vertices();
+}
+
+#endif
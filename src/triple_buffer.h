@@ -0,0 +1,85 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <atomic>
+
+/* A value passed from one thread to another without either waiting.
+ *
+ * Of three copies of the value, the writer owns one, the reader owns
+ * one, and the third is the one most recently published.  "publish"
+ * swaps the writer's copy with the published one, and "update" swaps
+ * the reader's copy with the published one if it is newer than what
+ * the reader has.  Each swap is one atomic exchange, so neither thread
+ * ever waits for the other; a value published twice before the reader
+ * updates is replaced, and the reader keeps its copy until a newer
+ * one is published.
+ *
+ * Exactly one thread may write, and exactly one may read.
+ */
+template<typename T>
+class triple_buffer {
+public:
+  triple_buffer():
+    back(0),
+    middle(1),
+    front(2)
+  {}
+
+  /* the writer's copy */
+  T &
+  writer()
+  {
+    return copies[back].value;
+  }
+
+  /* make the writer's copy the newest.  Returns true if the previous
+   * one was replaced before the reader saw it
+   */
+  bool
+  publish()
+  {
+    const int previous = middle.exchange(back | fresh, std::memory_order_acq_rel);
+    back = previous & ~fresh;
+    return (previous & fresh) != 0;
+  }
+
+  /* take the newest copy, if one was published since the last update.
+   * Returns false if there was none
+   */
+  bool
+  update()
+  {
+    if(!(middle.load(std::memory_order_relaxed) & fresh)){
+      return false;
+    }
+    front = middle.exchange(front, std::memory_order_acq_rel) & ~fresh;
+    return true;
+  }
+
+  /* the reader's copy */
+  const T &
+  reader() const
+  {
+    return copies[front].value;
+  }
+
+private:
+  // set in "middle" when it holds a copy the reader has not taken
+  static const int fresh = 4;
+  // on separate cache lines, so that the threads do not contend
+  struct alignas(64) copy {
+    T value;
+  };
+  copy copies[3];
+  int back;
+  std::atomic<int> middle;
+  int front;
+};
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "main.h"
+#include "options.h"
+#include "vertex_capture.h"
+
+static bool active = false;
+static FILE *file = NULL;
+static uint32_t frame = 0;
+static std::vector<vertex_capture_record> records;
+
+// frames waiting for the writer thread
+static std::thread writer;
+static std::mutex queue_mutex;
+static std::condition_variable queue_changed;
+static std::deque<std::vector<vertex_capture_record> > queue;
+static bool finished = false;
+
+// counters
+static unsigned long long records_written = 0;
+static size_t largest_queue = 0;
+
+static void
+write_frames()
+{
+  std::unique_lock<std::mutex> lock(queue_mutex);
+  for(;;){
+    queue_changed.wait(lock, [](){ return finished || !queue.empty(); });
+    if(queue.empty()){
+      return;
+    }
+    std::vector<vertex_capture_record> frame_records;
+    frame_records.swap(queue.front());
+    queue.pop_front();
+    // write without holding the lock, so the render loop is never blocked
+    lock.unlock();
+    fwrite(&frame_records[0],
+           sizeof(vertex_capture_record),
+           frame_records.size(),
+           file);
+    records_written += frame_records.size();
+    lock.lock();
+  }
+}
+
+bool
+vertex_capture_requested()
+{
+  return option_string("VERTEX_CAPTURE", NULL) != NULL;
+}
+
+bool
+vertex_capture_active()
+{
+  return active;
+}
+
+bool
+vertex_capture_init()
+{
+  const char *path = option_string("VERTEX_CAPTURE", NULL);
+  file = fopen(path, "wb");
+  if(file == NULL){
+    fprintf(stderr, "Error: could not write %s\n", path);
+    return false;
+  }
+  const uint32_t header[2] = {sizeof(vertex_capture_record), 0};
+  fwrite(VERTEX_CAPTURE_MAGIC, 1, strlen(VERTEX_CAPTURE_MAGIC), file);
+  fwrite(header, sizeof(header), 1, file);
+  writer = std::thread(write_frames);
+  active = true;
+  return true;
+}
+
+void
+vertex_capture_record_vertex(int object,
+                             capture_stage stage,
+                             float x,
+                             float y,
+                             float z)
+{
+  vertex_capture_record r;
+  r.frame = frame;
+  r.object = (uint16_t) object;
+  r.stage = (uint8_t) stage;
+  r.zero = 0;
+  r.x = x;
+  r.y = y;
+  r.z = z;
+  records.push_back(r);
+}
+
+void
+vertex_capture_end_frame()
+{
+  if(!active){
+    return;
+  }
+  frame++;
+  if(records.empty()){
+    return;
+  }
+  std::vector<vertex_capture_record> frame_records;
+  // keep the capacity for the next frame
+  frame_records.reserve(records.size());
+  frame_records.swap(records);
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    queue.push_back(std::vector<vertex_capture_record>());
+    queue.back().swap(frame_records);
+    if(queue.size() > largest_queue){
+      largest_queue = queue.size();
+    }
+  }
+  queue_changed.notify_one();
+}
+
+void
+vertex_capture_shutdown()
+{
+  if(!active){
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    finished = true;
+  }
+  queue_changed.notify_one();
+  writer.join();
+  fclose(file);
+  file = NULL;
+  active = false;
+  fprintf(stderr,
+          "vertex capture: %lu frames, %llu records written, "
+          "at most %lu frames queued\n",
+          (unsigned long) frame,
+          records_written,
+          (unsigned long) largest_queue);
+}
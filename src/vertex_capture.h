@@ -0,0 +1,115 @@
+#ifndef VERTEX_CAPTURE_H
+#define VERTEX_CAPTURE_H 1
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+#include <stdint.h>
+
+/* Capture of each vertex at every stage of the transformation pipeline.
+ *
+ * If MVP_VERTEX_CAPTURE=file is set, the chapters which name each
+ * space (modelspace, worldSpace, cameraSpace and ndcSpace) record
+ * every vertex they draw, in each of those spaces, to "file".  The
+ * records of a frame are handed to a writer thread at the end of the
+ * frame, so the render loop never waits on the disk.
+ *
+ * The file is a 16 byte header,
+ *
+ *   "MVPVCAP1", uint32 record size (20), uint32 zero,
+ *
+ * followed by fixed-size records, in the machine's native byte order,
+ * so that it may be mapped into memory and used as an array of
+ * "vertex_capture_record".  "vertex_capture_dump" converts slices of
+ * it into data files for gnuplot.
+ */
+
+enum capture_stage {
+  CAPTURE_MODEL,
+  CAPTURE_WORLD,
+  CAPTURE_CAMERA,
+  CAPTURE_NDC,
+  NUMBER_OF_CAPTURE_STAGES
+};
+
+struct vertex_capture_record {
+  uint32_t frame;
+  uint16_t object;
+  uint8_t stage;
+  uint8_t zero;
+  float x;
+  float y;
+  float z;
+};
+
+#define VERTEX_CAPTURE_MAGIC "MVPVCAP1"
+#define VERTEX_CAPTURE_HEADER_BYTES 16
+
+bool
+vertex_capture_requested();
+
+bool
+vertex_capture_active();
+
+/* open the file and start the writer thread.  Returns false, after
+ * printing the reason to stderr, if the file cannot be written.
+ */
+bool
+vertex_capture_init();
+
+void
+vertex_capture_record_vertex(int object,
+                             capture_stage stage,
+                             float x,
+                             float y,
+                             float z);
+
+/* hand this frame's records to the writer thread */
+void
+vertex_capture_end_frame();
+
+/* write the remaining records, and close the file */
+void
+vertex_capture_shutdown();
+
+/* the z coordinate of a vertex, or 0 for two-dimensional vertices */
+template<typename V>
+inline auto
+vertex_capture_z(const V &v, int) -> decltype(v.z)
+{
+  return v.z;
+}
+
+template<typename V>
+inline float
+vertex_capture_z(const V &, long)
+{
+  return 0.0f;
+}
+
+/* record one vertex of "object", in each of the four spaces */
+template<typename V>
+inline void
+vertex_capture(int object,
+               const V &model,
+               const V &world,
+               const V &camera,
+               const V &ndc)
+{
+  if(!vertex_capture_active()){
+    return;
+  }
+  vertex_capture_record_vertex(object, CAPTURE_MODEL,
+                               model.x, model.y, vertex_capture_z(model, 0));
+  vertex_capture_record_vertex(object, CAPTURE_WORLD,
+                               world.x, world.y, vertex_capture_z(world, 0));
+  vertex_capture_record_vertex(object, CAPTURE_CAMERA,
+                               camera.x, camera.y, vertex_capture_z(camera, 0));
+  vertex_capture_record_vertex(object, CAPTURE_NDC,
+                               ndc.x, ndc.y, vertex_capture_z(ndc, 0));
+}
+
+#endif
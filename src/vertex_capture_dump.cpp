@@ -0,0 +1,157 @@
+/*
+ * William Emerison Six
+ *
+ * Copyright 2016-2017 - William Emerison Six
+ * All rights reserved
+ * Distributed under Apache 2.0
+ */
+
+/* Convert a slice of a vertex capture into a data file for gnuplot.
+ *
+ *   vertex_capture_dump FILE STAGE [FIRST_FRAME [LAST_FRAME [OBJECT]]]
+ *
+ * STAGE is one of "model", "world", "camera" or "ndc".  The vertices
+ * of each object, in each frame, are printed as "x y z" lines, with
+ * the first vertex repeated so that gnuplot draws a closed polygon,
+ * and a blank line between objects.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#ifndef _WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "vertex_capture.h"
+
+static const char *stage_names[NUMBER_OF_CAPTURE_STAGES] = {
+  "model",
+  "world",
+  "camera",
+  "ndc"
+};
+
+static void
+print_polygon(const std::vector<const vertex_capture_record *> &polygon)
+{
+  if(polygon.empty()){
+    return;
+  }
+  for(size_t i = 0; i <= polygon.size(); i++){
+    const vertex_capture_record *r = polygon[i % polygon.size()];
+    printf("%g %g %g\n", r->x, r->y, r->z);
+  }
+  printf("\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+  if(argc < 3){
+    fprintf(stderr,
+            "usage: %s FILE model|world|camera|ndc "
+            "[FIRST_FRAME [LAST_FRAME [OBJECT]]]\n",
+            argv[0]);
+    return 1;
+  }
+  int stage = 0;
+  while(stage < NUMBER_OF_CAPTURE_STAGES && strcmp(argv[2], stage_names[stage]) != 0){
+    stage++;
+  }
+  if(stage == NUMBER_OF_CAPTURE_STAGES){
+    fprintf(stderr, "Error: unknown stage %s\n", argv[2]);
+    return 1;
+  }
+  const unsigned long first_frame = argc > 3 ? strtoul(argv[3], NULL, 10) : 0;
+  const unsigned long last_frame = argc > 4 ? strtoul(argv[4], NULL, 10) : first_frame;
+  const long object = argc > 5 ? strtol(argv[5], NULL, 10) : -1;
+
+  // map the capture, so that only the pages holding the slice are read
+#ifdef _WINDOWS
+  FILE *file = fopen(argv[1], "rb");
+  if(file == NULL){
+    fprintf(stderr, "Error: could not read %s\n", argv[1]);
+    return 1;
+  }
+  std::vector<char> contents;
+  char buffer[65536];
+  size_t n;
+  while((n = fread(buffer, 1, sizeof(buffer), file)) > 0){
+    contents.insert(contents.end(), buffer, buffer + n);
+  }
+  fclose(file);
+  const char *data = contents.empty() ? NULL : &contents[0];
+  const size_t size = contents.size();
+#else
+  const int descriptor = open(argv[1], O_RDONLY);
+  struct stat status;
+  if(descriptor < 0 || fstat(descriptor, &status) != 0){
+    fprintf(stderr, "Error: could not read %s\n", argv[1]);
+    return 1;
+  }
+  const size_t size = (size_t) status.st_size;
+  const char *data = size == 0 ? NULL : (const char *) mmap(NULL,
+                                                            size,
+                                                            PROT_READ,
+                                                            MAP_PRIVATE,
+                                                            descriptor,
+                                                            0);
+  close(descriptor);
+  if(data == MAP_FAILED){
+    fprintf(stderr, "Error: could not map %s\n", argv[1]);
+    return 1;
+  }
+#endif
+  uint32_t record_size = 0;
+  if(size < VERTEX_CAPTURE_HEADER_BYTES
+     || memcmp(data, VERTEX_CAPTURE_MAGIC, strlen(VERTEX_CAPTURE_MAGIC)) != 0
+     || (memcpy(&record_size, data + 8, sizeof(record_size)),
+         record_size != sizeof(vertex_capture_record))){
+    fprintf(stderr, "Error: %s is not a vertex capture\n", argv[1]);
+    return 1;
+  }
+  const vertex_capture_record *records =
+    (const vertex_capture_record *) (data + VERTEX_CAPTURE_HEADER_BYTES);
+  const size_t number_of_records =
+    (size - VERTEX_CAPTURE_HEADER_BYTES) / sizeof(vertex_capture_record);
+
+  // records are in frame order, and each object's vertices are
+  // contiguous, so the slice begins where a binary search finds it
+  const vertex_capture_record *first =
+    std::lower_bound(records,
+                     records + number_of_records,
+                     first_frame,
+                     [](const vertex_capture_record &r, unsigned long frame){
+                       return r.frame < frame;
+                     });
+  std::vector<const vertex_capture_record *> polygon;
+  for(size_t i = (size_t) (first - records); i < number_of_records; i++){
+    const vertex_capture_record *r = &records[i];
+    if(r->frame > last_frame){
+      break;
+    }
+    if(r->frame < first_frame
+       || r->stage != stage
+       || (object >= 0 && r->object != object)){
+      continue;
+    }
+    if(!polygon.empty()
+       && (polygon.back()->frame != r->frame
+           || polygon.back()->object != r->object)){
+      print_polygon(polygon);
+      polygon.clear();
+    }
+    polygon.push_back(r);
+  }
+  print_polygon(polygon);
+#ifndef _WINDOWS
+  if(data != NULL){
+    munmap((void *) data, size);
+  }
+#endif
+  return 0;
+}